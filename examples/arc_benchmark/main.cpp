@@ -0,0 +1,119 @@
+// Compares rendering a solid arc pixel by pixel, as ArcBasedView::process() did, with filling its
+// spans, for several arc widths and for several arcs on one ring. Also checks both write the same
+// pixels.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o arc_benchmark
+
+#include <HostBenchmark.h>
+#include <PixelRing.h>
+#include <cstdio>
+
+static const uint16_t led_count = 300;
+using Ring = PixelRing<led_count, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+
+//! The arc walked pixel by pixel with a wrapping iterator, switching the color at its end.
+static void renderPerPixel(HostStrip &strip, uint16_t first, uint16_t width, uint32_t color)
+{
+    const uint32_t off = 0;
+    CappedNumber<led_count> pixel{ first };
+    const CappedNumber<led_count> end{ static_cast<uint16_t>(first + width) };
+    const uint32_t *current = &color;
+    for(uint16_t i = 0; i < led_count; i++, ++pixel)
+    {
+        if(pixel == end)
+            current = &off;
+        strip.setPixelColor(pixel, *current);
+    }
+}
+
+//! \return ns per frame of the red scene shifted by one pixel each frame
+static double nsPerSpanFrame(Ring &ring, uint32_t frames)
+{
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = 10;
+    return HostBenchmark::nsPer(frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+        {
+            ring.shift(1);
+            ring.render(tick);
+        }
+    });
+}
+
+//! Shows the red scene on an arc of the given width.
+static void prepare(Ring &ring, uint16_t width)
+{
+    ring.setup();
+    ring.getStrip().recordFrames(false);
+    ring.process(Ring::SceneMode::Red);
+    ring.fullWidth();
+    for(uint16_t w = led_count; w > width; w--)
+        ring.incrementWidth(-1);
+}
+
+int main()
+{
+    const uint32_t frames = 100000;
+    const uint32_t red = HostStrip::Color(255, 0, 0);
+    bool same = true;
+
+    std::printf("%-28s %10s %10s\n", "ns/frame", "per pixel", "spans");
+    for(uint16_t width : { 1, 30, 150, 299, 300 })
+    {
+        HostStrip strip{ led_count };
+        volatile uint8_t sink = 0;
+        const double per_pixel = HostBenchmark::nsPer(frames, [&]() {
+            for(uint32_t f = 0; f < frames; f++)
+                renderPerPixel(strip, static_cast<uint16_t>(f % led_count), width, red);
+            sink = strip.getPixels()[0];
+        });
+        (void)sink;
+
+        Ring ring;
+        prepare(ring, width);
+        const double spans = nsPerSpanFrame(ring, frames);
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "arc of %u", width);
+        std::printf("%-28s %10.1f %10.1f\n", label, per_pixel, spans);
+    }
+
+    // three arcs of 20 pixels
+    Ring ring;
+    prepare(ring, 20);
+    ring.getLayers().addArc(100, 20);
+    ring.getLayers().addArc(200, 20);
+    const double three_arcs = nsPerSpanFrame(ring, frames);
+    std::printf("%-28s %10s %10.1f\n", "3 arcs of 20", "-", three_arcs);
+
+    // both ways of rendering write the same pixels, wherever the arc is
+    for(uint16_t width = 1; width <= led_count; width += 37)
+    {
+        Ring check;
+        prepare(check, width);
+        for(uint16_t shift = 0; shift < led_count; shift += 13)
+        {
+            check.shift(13);
+            FrameTick tick;
+            tick.frames = 1;
+            tick.period_ms = 10;
+            check.render(tick);
+
+            // the first pixel of the arc is the first lit pixel after an unlit one
+            uint16_t first = 0;
+            for(uint16_t i = 0; i < led_count; i++)
+                if(check.getStrip().getPixelColor(i) != 0 &&
+                   (width == led_count ||
+                    check.getStrip().getPixelColor((i + led_count - 1) % led_count) == 0))
+                    first = i;
+
+            HostStrip expected{ led_count };
+            renderPerPixel(expected, first, width, red);
+            for(uint16_t i = 0; i < led_count; i++)
+                same = same && expected.getPixelColor(i) == check.getStrip().getPixelColor(i);
+        }
+    }
+    std::printf("same pixels: %s\n", same ? "ok" : "FAILED");
+    return same ? 0 : 1;
+}
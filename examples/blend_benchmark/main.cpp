@@ -0,0 +1,105 @@
+// Compares a per byte lerp of two pixel buffers with the fixed point SWAR blend of CrossFade, and
+// measures whole frames of a PixelRing crossfading between two animated scenes.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o blend_benchmark
+
+#include <HostBenchmark.h>
+#include <PixelRing.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+
+//! Straight forward lerp, one byte at a time.
+static void lerpPerByte(uint8_t *out, const uint8_t *from, const uint8_t *to, uint16_t size,
+                        uint16_t weight)
+{
+    for(uint16_t i = 0; i < size; i++)
+        out[i] = static_cast<uint8_t>(from[i] + (((to[i] - from[i]) * weight) >> 8));
+}
+
+template <typename Ring> static double nsPerTransitionFrame(uint32_t frames)
+{
+    Ring ring;
+    ring.setup();
+    ring.getStrip().recordFrames(false);
+    ring.setTransitionDuration(60000);
+    ring.process(Ring::SceneMode::Rainbow);
+    ring.process(Ring::SceneMode::TheaterChaseRainbow);
+
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = 10;
+    return HostBenchmark::nsPer(frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+            ring.render(tick);
+    });
+}
+
+template <typename Ring> static double nsPerFrame(uint32_t frames)
+{
+    Ring ring;
+    ring.setup();
+    ring.getStrip().recordFrames(false);
+    ring.process(Ring::SceneMode::Rainbow);
+
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = 10;
+    return HostBenchmark::nsPer(frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+            ring.render(tick);
+    });
+}
+
+int main()
+{
+    const uint16_t led_count = 300;
+    const uint16_t size = led_count * 3;
+    const uint32_t frames = 20000;
+
+    std::vector<uint8_t> from(size), to(size), out(size);
+    for(uint16_t i = 0; i < size; i++)
+    {
+        from[i] = static_cast<uint8_t>(i * 7);
+        to[i] = static_cast<uint8_t>(255 - i * 13);
+    }
+    volatile uint8_t sink = 0;
+
+    const double per_byte = HostBenchmark::nsPer(led_count * frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+            lerpPerByte(out.data(), from.data(), to.data(), size, f & 0xff);
+        sink = out[0];
+    });
+
+    const double swar = HostBenchmark::nsPer(led_count * frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+            CrossFade::blend(out.data(), from.data(), to.data(), size, f & 0xff);
+        sink = out[0];
+    });
+
+    uint32_t max_deviation = 0;
+    for(uint16_t weight = 0; weight <= CrossFade::max_weight; weight++)
+    {
+        std::vector<uint8_t> a(size), b(size);
+        lerpPerByte(a.data(), from.data(), to.data(), size, weight);
+        CrossFade::blend(b.data(), from.data(), to.data(), size, weight);
+        for(uint16_t i = 0; i < size; i++)
+            max_deviation = std::max(max_deviation, static_cast<uint32_t>(std::abs(a[i] - b[i])));
+    }
+
+    using Ring = PixelRing<led_count, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+    // 10 [ms] per frame, the transition of 60 [s] is not completed within the frames measured
+    const double plain_frame = nsPerFrame<Ring>(5000);
+    const double transition_frame = nsPerTransitionFrame<Ring>(5000);
+
+    std::printf("%-28s %10s\n", "blend kernel", "ns/pixel");
+    std::printf("%-28s %10.2f\n", "lerp per byte", per_byte);
+    std::printf("%-28s %10.2f\n", "SWAR CrossFade::blend", swar);
+    std::printf("max channel deviation: %u\n", max_deviation);
+    std::printf("%-28s %10s\n", "PixelRing<300> frame", "ns/frame");
+    std::printf("%-28s %10.0f\n", "rainbow", plain_frame);
+    std::printf("%-28s %10.0f\n", "rainbow -> chase rainbow", transition_frame);
+    (void)sink;
+    return 0;
+}
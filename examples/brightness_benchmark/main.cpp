@@ -0,0 +1,96 @@
+// Compares the per channel brightness override (divide by 100 per channel) with the fixed point
+// SWAR scaling of BrightnessScale, per color as well as on a whole strip buffer.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o brightness_benchmark
+
+#include <BrightnessScale.h>
+#include <HostBackend.h>
+#include <HostBenchmark.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+//! The brightness override as done before BrightnessScale.
+struct PerChannelBrightness
+{
+    uint8_t channel(uint8_t color_value) const
+    {
+        uint16_t color = ((uint16_t)brightness_override * (uint16_t)brightness *
+                          (uint16_t)color_value) /
+                         (uint16_t)100;
+        color = color > 255 ? 255 : color;
+        return static_cast<uint8_t>(color);
+    }
+
+    uint32_t apply(uint32_t color) const
+    {
+        uint8_t r = static_cast<uint8_t>((color & 0x00ff0000) >> 16);
+        uint8_t g = static_cast<uint8_t>((color & 0x0000ff00) >> 8);
+        uint8_t b = static_cast<uint8_t>((color & 0x000000ff));
+        return HostStrip::Color(channel(r), channel(g), channel(b));
+    }
+
+    uint8_t brightness;
+    uint8_t brightness_override;
+};
+
+int main()
+{
+    const uint16_t led_count = 300;
+    const uint32_t frames = 20000;
+    const uint8_t brightness = 42;
+
+    std::vector<uint32_t> colors(led_count);
+    for(uint16_t i = 0; i < led_count; i++)
+        colors[i] = HostStrip::gamma32(HostStrip::ColorHSV(static_cast<uint16_t>(i * 218)));
+
+    HostStrip strip{ led_count, D0, NEO_GRB + NEO_KHZ800 };
+    volatile uint32_t sink = 0;
+
+    const PerChannelBrightness per_channel{ brightness, 1 };
+    const double legacy = HostBenchmark::nsPer(led_count * frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+            for(uint16_t i = 0; i < led_count; i++)
+                strip.setPixelColor(i, per_channel.apply(colors[i]));
+        sink = strip.getPixels()[0];
+    });
+
+    const uint16_t scale = BrightnessScale::fromPercent(brightness, true);
+    const double swar = HostBenchmark::nsPer(led_count * frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+            for(uint16_t i = 0; i < led_count; i++)
+                strip.setPixelColor(i, BrightnessScale::apply(colors[i], scale));
+        sink = strip.getPixels()[0];
+    });
+
+    const double buffer = HostBenchmark::nsPer(led_count * frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+        {
+            for(uint16_t i = 0; i < led_count; i++)
+                strip.setPixelColor(i, colors[i]);
+            BrightnessScale::apply(strip.getPixels(), led_count * 3, scale);
+        }
+        sink = strip.getPixels()[0];
+    });
+
+    uint32_t max_deviation = 0;
+    for(uint16_t i = 0; i < led_count; i++)
+    {
+        const uint32_t a = per_channel.apply(colors[i]);
+        const uint32_t b = BrightnessScale::apply(colors[i], scale);
+        for(uint8_t shift = 0; shift < 24; shift += 8)
+        {
+            const int32_t d = static_cast<int32_t>((a >> shift) & 0xff) -
+                              static_cast<int32_t>((b >> shift) & 0xff);
+            max_deviation = std::max(max_deviation, static_cast<uint32_t>(d < 0 ? -d : d));
+        }
+    }
+
+    std::printf("%-24s %10s\n", "path", "ns/pixel");
+    std::printf("%-24s %10.2f\n", "per channel (legacy)", legacy);
+    std::printf("%-24s %10.2f\n", "SWAR per color", swar);
+    std::printf("%-24s %10.2f\n", "SWAR whole buffer", buffer);
+    std::printf("max channel deviation: %u\n", max_deviation);
+    (void)sink;
+    return 0;
+}
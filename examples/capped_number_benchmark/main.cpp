@@ -0,0 +1,185 @@
+// Compares CappedNumber with the modulo based implementation it replaced: first checks both agree
+// on every value and every delta within +/- MAX (and the new one is right beyond), then times
+// increments and random steps for a power of two and for another size.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o capped_number_benchmark
+
+#include <CappedNumber.h>
+#include <HostBenchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//! CappedNumber as it was, trimming by modulo after each operation.
+template <uint16_t MAX> struct LegacyCappedNumber
+{
+    LegacyCappedNumber(uint16_t val)
+    {
+        value = val;
+        trim();
+    }
+
+    LegacyCappedNumber &operator++()
+    {
+        operator+=(1);
+        return *this;
+    }
+
+    LegacyCappedNumber &operator--()
+    {
+        operator-=(1);
+        return *this;
+    }
+
+    LegacyCappedNumber &operator-=(const int16_t val)
+    {
+        if(val < 0) // increment
+            value += -val;
+        else // decrement
+        {
+            if(val > value) // on underflow
+                value = MAX - (val - value);
+            else
+                value -= val;
+        }
+        trim();
+        return *this;
+    }
+
+    LegacyCappedNumber &operator+=(int16_t val)
+    {
+        if(val > 0) // increment
+            value += val;
+        else // decrement
+        {
+            if(val + value < 0) // on underflow
+                value = MAX + (val + value);
+            else
+                value -= -val;
+        }
+
+        trim();
+        return *this;
+    }
+
+    operator uint16_t() { return value; }
+
+private:
+    inline void trim() { value %= MAX; }
+
+    uint16_t value{ 0 };
+};
+
+// operations are usable in constant expressions
+static_assert(uint16_t(CappedNumber<24>(23) + uint16_t(2)) == 1, "");
+static_assert(uint16_t(CappedNumber<24>(1) - uint16_t(2)) == 23, "");
+static_assert(uint16_t(CappedNumber<32>(1) - CappedNumber<32>(3)) == 30, "");
+static_assert(uint16_t(CappedNumber<24>(30)) == 6, "");
+
+static uint16_t expected(uint16_t max, int32_t value, int32_t delta)
+{
+    return static_cast<uint16_t>(((value + delta) % max + max) % max);
+}
+
+//! \return number of mismatches of the legacy and the new implementation
+template <uint16_t MAX> static uint32_t check()
+{
+    uint32_t mismatches = 0;
+    for(uint32_t val = 0; val <= UINT16_MAX; val++)
+    {
+        mismatches += (uint16_t(LegacyCappedNumber<MAX>(static_cast<uint16_t>(val))) !=
+                       uint16_t(CappedNumber<MAX>(static_cast<uint16_t>(val))));
+    }
+
+    for(int32_t value = 0; value < MAX; value++)
+    {
+        // the legacy implementation is correct within +/- MAX only, the new one beyond
+        for(int32_t delta = -3 * MAX; delta <= 3 * MAX; delta++)
+        {
+            CappedNumber<MAX> add{ static_cast<uint16_t>(value) };
+            CappedNumber<MAX> sub{ static_cast<uint16_t>(value) };
+            add += delta;
+            sub -= delta;
+            mismatches += (add != expected(MAX, value, delta));
+            mismatches += (sub != expected(MAX, value, -delta));
+
+            if(delta <= -MAX || delta >= MAX)
+                continue;
+
+            LegacyCappedNumber<MAX> legacy_add{ static_cast<uint16_t>(value) };
+            LegacyCappedNumber<MAX> legacy_sub{ static_cast<uint16_t>(value) };
+            legacy_add += static_cast<int16_t>(delta);
+            legacy_sub -= static_cast<int16_t>(delta);
+            mismatches += (uint16_t(legacy_add) != add);
+            mismatches += (uint16_t(legacy_sub) != sub);
+        }
+
+        CappedNumber<MAX> n{ static_cast<uint16_t>(value) };
+        LegacyCappedNumber<MAX> legacy{ static_cast<uint16_t>(value) };
+        mismatches += (uint16_t(++legacy) != ++n);
+        mismatches += (uint16_t(--legacy) != --n);
+        mismatches += (uint16_t(--legacy) != --n);
+        mismatches += (CappedNumber<MAX>(static_cast<uint16_t>(value)) + CappedNumber<MAX>(3) !=
+                       expected(MAX, value, 3));
+    }
+    return mismatches;
+}
+
+template <typename Number> static double increments(uint32_t ops)
+{
+    volatile uint32_t sink = 0;
+    const double ns = HostBenchmark::nsPer(ops, [&]() {
+        Number n{ 0 };
+        uint32_t sum = 0;
+        for(uint32_t i = 0; i < ops; i++)
+            sum += ++n;
+        sink = sum;
+    });
+    (void)sink;
+    return ns;
+}
+
+template <typename Number> static double steps(const std::vector<int8_t> &deltas)
+{
+    volatile uint32_t sink = 0;
+    const double ns = HostBenchmark::nsPer(static_cast<uint32_t>(deltas.size()), [&]() {
+        Number n{ 0 };
+        uint32_t sum = 0;
+        for(int8_t delta : deltas)
+        {
+            n += delta;
+            sum += n;
+        }
+        sink = sum;
+    });
+    (void)sink;
+    return ns;
+}
+
+template <uint16_t MAX> static void benchmark(const std::vector<int8_t> &deltas)
+{
+    const uint32_t ops = 50000000;
+    std::printf("MAX %-5u %-10s %10.2f %10.2f\n", MAX, "++",
+                increments<LegacyCappedNumber<MAX>>(ops), increments<CappedNumber<MAX>>(ops));
+    std::printf("MAX %-5u %-10s %10.2f %10.2f\n", MAX, "+= random",
+                steps<LegacyCappedNumber<MAX>>(deltas), steps<CappedNumber<MAX>>(deltas));
+}
+
+int main()
+{
+    const uint32_t mismatches = check<1>() + check<16>() + check<24>() + check<60>() +
+                                check<64>() + check<300>() + check<1024>();
+    std::printf("mismatches: %u\n", mismatches);
+
+    std::vector<int8_t> deltas(10000000);
+    std::srand(1);
+    for(int8_t &delta : deltas)
+        delta = static_cast<int8_t>(std::rand() % 15 - 7);
+
+    std::printf("%-20s %10s %10s\n", "ns/op", "legacy", "new");
+    benchmark<24>(deltas);
+    benchmark<32>(deltas);
+    benchmark<300>(deltas);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Measures the effect kernels on a 300 pixel strip: the time of a kernel step alone and of a whole
+// frame of its scene (step, compose and transmission into the strip buffer), each the fastest of
+// several repetitions, together with the RAM of the scene state. Checks that every scene renders
+// the frame budget of 10 ms (100 fps) with a wide margin.
+//
+// Note that these are host numbers, they show the relation between the kernels and the rest of
+// the frame rather than the frame rate of a microcontroller.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o effect_benchmark
+
+#include <EffectScenes.h>
+#include <HostBenchmark.h>
+#include <PixelRing.h>
+#include <cstdio>
+
+static const uint16_t led_count = 300;
+//! steps per repetition, the fastest of the repetitions counts
+static const uint32_t steps = 1000;
+static const uint8_t repetitions = 20;
+
+// kernel states, global so that the kernel steps are not optimized away
+static Xorshift32 generator;
+static uint8_t heat[led_count];
+static uint8_t intensity[led_count];
+static uint8_t level[led_count];
+static uint8_t hue[led_count];
+static uint32_t head;
+static uint16_t offset;
+static volatile uint8_t sink;
+
+using Ring = PixelRing<led_count, D0, NEO_GRB + NEO_KHZ800, HostBackend, EffectScenes>;
+template <typename Scene> using StateOf = typename SceneStateOf<Scene, led_count>::type;
+
+//! \return the fastest time per call of function in [ns]
+template <typename Function> static double nsPerCall(const Function &function)
+{
+    return HostBenchmark::nsPer(
+    steps,
+    [&function]() {
+        for(uint32_t s = 0; s < steps; s++)
+            function();
+    },
+    repetitions);
+}
+
+//! \return the fastest time per frame of the current scene of the ring in [ns]
+static double nsPerFrame(Ring &ring)
+{
+    FrameTick tick;
+    tick.frames = 1;
+    // each frame is a step of every effect
+    tick.period_ms = 20;
+    return nsPerCall([&ring, &tick]() {
+        ring.render(tick);
+        ring.flush();
+    });
+}
+
+static bool report(const char *name, double kernel_ns, double frame_ns, size_t state_size)
+{
+    std::printf("%-10s %12.1f %12.1f %12zu\n", name, kernel_ns, frame_ns, state_size);
+    // a tenth of the frame budget even on the host
+    return frame_ns < 1000000.0;
+}
+
+int main()
+{
+    Ring ring;
+    ring.setup();
+    ring.getStrip().recordFrames(false);
+
+    std::printf("%u pixels\n", led_count);
+    std::printf("%-10s %12s %12s %12s\n", "", "kernel ns", "frame ns", "state bytes");
+
+    bool ok = true;
+    ring.setScene<FireSceneDefault>();
+    ok = report("fire", nsPerCall([]() { FireKernel::step(heat, generator, 55, 120); }),
+                nsPerFrame(ring), sizeof(StateOf<FireSceneDefault>)) &&
+         ok;
+
+    ring.setScene<CometWhiteScene>();
+    ok = report("comet", nsPerCall([]() { CometKernel::step(intensity, head, 4096, 200); }),
+                nsPerFrame(ring), sizeof(StateOf<CometWhiteScene>)) &&
+         ok;
+
+    ring.setScene<TwinkleSceneDefault>();
+    ok = report("twinkle", nsPerCall([]() { TwinkleKernel::step(level, hue, generator, 4, 235); }),
+                nsPerFrame(ring), sizeof(StateOf<TwinkleSceneDefault>)) &&
+         ok;
+
+    ring.setScene<NoiseSceneDefault>();
+    const double noise_ns = nsPerCall([]() {
+        for(uint16_t pixel = 0; pixel < led_count; pixel++)
+            sink = static_cast<uint8_t>(sink + NoiseKernel::fractal(pixel * 24U + offset));
+        offset = static_cast<uint16_t>(offset + 16);
+    });
+    ok = report("noise", noise_ns, nsPerFrame(ring), sizeof(StateOf<NoiseSceneDefault>)) &&
+         ok;
+
+    std::printf("ring %zu bytes (scene state and the one of the previous scene included)\n",
+                sizeof(Ring));
+    std::printf("frames emitted %u, within the frame budget: %s\n",
+                ring.getFrameCounters().emitted, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
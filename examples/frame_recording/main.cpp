@@ -0,0 +1,101 @@
+// Records the frames of every scene into the compact frame format, replays each recording into a
+// second simulated strip and checks both frame logs are identical, pixel by pixel and in time.
+// Each recording is replayed once more as arriving over a live stream, a few bytes per ms.
+// The recording is what a golden output test would compare against, or what would be played
+// from flash instead of rendering live.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o frame_recording
+
+#include <FrameRecording.h>
+#include <PixelRing.h>
+#include <cstdio>
+
+using Ring = PixelRing<24, D0, NEO_GRB + NEO_KHZ400, HostBackend>;
+using Recorder = FrameRecorder<HostStream, Ring::led_count, Ring::bytes_per_pixel>;
+
+//! \param chunk bytes arriving per ms over a live stream, 0 to replay the recording as a file
+//! \return true if the replayed frames match the recorded ones, frames arriving over a live stream
+//! in pixels only since they are shown late if arriving late
+static bool replay(HostStream &recording, const std::vector<HostStrip::Frame> &expected,
+                   uint16_t chunk = 0)
+{
+    HostStrip strip{ Ring::led_count, D0, NEO_GRB + NEO_KHZ400 };
+    strip.begin();
+
+    // the live stream has the header buffered already, the frames follow in chunks
+    HostStream stream;
+    size_t fed = 0;
+    const auto feed = [&stream, &recording, &fed](size_t bytes) {
+        for(; bytes > 0 && fed < recording.bytes.size(); bytes--)
+            stream.write(recording.bytes[fed++]);
+    };
+    feed(FrameFormat::header_size);
+
+    FramePlayer<HostStream> player{ chunk ? stream : recording, chunk > 0 };
+    const uint32_t start_ms = expected.empty() ? 0 : expected.front().time_ms;
+    if(!player.begin(strip.getPixels(), Ring::led_count, Ring::bytes_per_pixel, start_ms))
+        return false;
+
+    // poll once per ms as a sketch's loop() would, a live stream until all frames arrived
+    for(uint32_t ms = start_ms; player.status() == FramePlayer<HostStream>::Status::Playing &&
+                                (chunk == 0 || player.frames() < expected.size());
+        ms++)
+    {
+        HostClock::set(ms);
+        feed(chunk);
+        if(player.poll(ms))
+            strip.show();
+    }
+
+    const std::vector<HostStrip::Frame> &frames = strip.getFrames();
+    const auto status = chunk ? FramePlayer<HostStream>::Status::Playing :
+                                FramePlayer<HostStream>::Status::Finished;
+    if(player.status() != status || frames.size() != expected.size())
+        return false;
+
+    for(size_t i = 0; i < frames.size(); i++)
+    {
+        if((chunk == 0 && frames[i].time_ms != expected[i].time_ms) ||
+           frames[i].pixels != expected[i].pixels)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    const uint32_t duration_ms = 2000;
+
+    std::printf("%-20s %8s %10s %10s %8s %8s %8s\n", "scene", "frames", "raw bytes", "recorded",
+                "ratio", "replay", "live");
+    for(uint8_t s = 0; s < static_cast<uint8_t>(Ring::SceneMode::None); s++)
+    {
+        Ring ring;
+        ring.setup();
+        ring.getStrip().resetFrames();
+        ring.incrementWidth(-8);
+
+        HostStream recording;
+        Recorder recorder{ recording };
+        recorder.attach(ring);
+
+        for(uint32_t ms = 0; ms < duration_ms; ms++)
+        {
+            HostClock::advance(1);
+            ring.process(static_cast<Ring::SceneMode>(s));
+        }
+
+        const uint32_t raw = recorder.frames() * Recorder::frame_size;
+        const double ratio = static_cast<double>(raw) / recorder.bytes();
+        const bool replayed = replay(recording, ring.getStrip().getFrames());
+        // 7 bytes per ms split the frames at any byte
+        const bool streamed = replay(recording, ring.getStrip().getFrames(), 7);
+        std::printf("%-20u %8u %10u %10u %8.1f %8s %8s\n", s, recorder.frames(), raw,
+                    recorder.bytes(), ratio, replayed ? "ok" : "FAILED",
+                    streamed ? "ok" : "FAILED");
+        if(!replayed || !streamed)
+            return 1;
+    }
+
+    return 0;
+}
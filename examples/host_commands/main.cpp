@@ -0,0 +1,91 @@
+// Posts control commands to a ring from several threads while the main thread renders, as button
+// ISRs and a network task would on a second core, and checks that no command is lost: the shifts
+// add up, the brightness steps and the toggles cancel each other out.
+//
+// build: g++ -std=c++11 -O2 -pthread -I../../src main.cpp -o host_commands
+
+#include <PixelRing.h>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using Ring = PixelRing<60, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+using Kind = Ring::Command::Kind;
+
+//! \return the first lit pixel, led_count if none
+static uint16_t litPixel(Ring &ring)
+{
+    for(uint16_t i = 0; i < Ring::led_count; i++)
+        if(ring.getStrip().getPixelColor(i) != 0)
+            return i;
+    return Ring::led_count;
+}
+
+int main()
+{
+    const uint8_t producers = 4;
+    const uint32_t rounds = 5000;
+
+    Ring ring;
+    ring.setup();
+    ring.getStrip().recordFrames(false);
+    ring.process(Ring::SceneMode::Red);
+
+    // a single pixel at half brightness
+    for(uint16_t i = 1; i < Ring::led_count; i++)
+        ring.incrementWidth(-1);
+    ring.incrementBrightness(-20);
+    ring.incrementBrightness(-20);
+    ring.incrementBrightness(-10);
+    HostClock::advance(10);
+    ring.process();
+    const uint16_t start = litPixel(ring);
+
+    std::atomic<uint32_t> full{ 0 };
+    std::atomic<uint8_t> running{ producers };
+    auto post = [&](Kind kind, int16_t value) {
+        while(!ring.post(kind, value))
+        {
+            ++full;
+            std::this_thread::yield();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(uint8_t p = 0; p < producers; p++)
+        threads.emplace_back([&]() {
+            for(uint32_t r = 0; r < rounds; r++)
+            {
+                post(Kind::Shift, 1);
+                post(Kind::Brightness, 1);
+                post(Kind::ToggleOnOff, 0);
+                post(Kind::Brightness, -1);
+                post(Kind::ToggleOnOff, 0);
+            }
+            --running;
+        });
+
+    uint32_t frames = 0;
+    while(running > 0)
+    {
+        HostClock::advance(1);
+        ring.process();
+        ++frames;
+        // the rest of the frame period is left to the producers
+        std::this_thread::yield();
+    }
+    for(std::thread &thread : threads)
+        thread.join();
+    HostClock::advance(10);
+    ring.process();
+
+    const uint32_t posted = producers * rounds * 5;
+    const uint16_t expected = (start + producers * rounds) % Ring::led_count;
+    const bool ok = litPixel(ring) == expected && ring.getBrightness() == 50 && ring.isOn();
+    std::printf("posted %u commands in %u frames, %.1f per frame, queue full %u times\n", posted,
+                frames, static_cast<double>(posted) / frames, full.load());
+    std::printf("pixel %u (expected %u), brightness %u, on %u: %s\n", litPixel(ring), expected,
+                ring.getBrightness(), ring.isOn(), ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Runs a ring whose scene takes 4 ms to render on a strip taking as long as a real 300 pixel
+// WS2812 strip to transmit (about 9 ms), once rendering and transmitting back to back and once
+// pipelined with the transmit stage on a std::thread. Reports frame rate and latency and checks
+// that no transmitted frame mixes pixels of two frames.
+//
+// build: g++ -std=c++11 -O2 -pthread -I../../src main.cpp -o host_pipeline
+
+#include <FramePipeline.h>
+#include <PixelRing.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+static const uint32_t render_us = 4000;
+static const uint32_t run_ms = 2000;
+
+static uint32_t realMillis()
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch())
+                                 .count());
+}
+
+//! Uniform color which changes each frame, computed slowly pixel by pixel.
+struct BusyScene
+{
+    struct State
+    {
+        uint32_t frame{ 0 };
+    };
+
+    static constexpr bool cycled = true;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t)
+    {
+        ++state.frame;
+        const uint32_t color = HostStrip::Color(static_cast<uint8_t>(state.frame),
+                                                static_cast<uint8_t>(state.frame >> 8), 0x55);
+        ring.compose([color](uint16_t) {
+            const auto until = std::chrono::steady_clock::now() +
+                               std::chrono::microseconds(render_us / Ring::led_count);
+            while(std::chrono::steady_clock::now() < until)
+                ;
+            return color;
+        });
+        ring.emitFrame();
+    }
+};
+
+using Ring = PixelRing<300, D0, NEO_GRB + NEO_KHZ800, HostBackend, SceneList<BusyScene>>;
+
+//! \return true if each pixel of each frame has the color of the first pixel of the frame
+static bool untorn(const HostStrip &strip)
+{
+    for(const HostStrip::Frame &frame : strip.getFrames())
+        for(size_t i = 3; i < frame.pixels.size(); i++)
+            if(frame.pixels[i] != frame.pixels[i % 3])
+                return false;
+    return true;
+}
+
+static void prepare(Ring &ring)
+{
+    ring.getScheduler().setTargetFps(1000);
+    ring.getStrip().recordFrames(false);
+}
+
+int main()
+{
+    HostClock::setSource(&realMillis);
+
+    // sequential: the frame period is render + transmit
+    Ring sequential;
+    prepare(sequential);
+    sequential.setup();
+    sequential.getStrip().simulateWireTime(true);
+    sequential.getStrip().resetFrames();
+    const uint32_t sequential_start = realMillis();
+    while(realMillis() - sequential_start < run_ms)
+        sequential.process();
+    const uint32_t sequential_frames = sequential.getStrip().showCount();
+
+    // pipelined: the frame period is max(render, transmit)
+    Ring ring;
+    prepare(ring);
+    FramePipeline<Ring> pipeline{ ring };
+    pipeline.setup();
+    pipeline.getOutput().simulateWireTime(true);
+    pipeline.getOutput().resetFrames();
+
+    std::atomic<bool> running{ true };
+    std::thread transmitter([&]() {
+        while(running)
+            if(!pipeline.transmit())
+                std::this_thread::yield();
+    });
+    const uint32_t pipelined_start = realMillis();
+    while(realMillis() - pipelined_start < run_ms)
+        pipeline.render();
+    running = false;
+    transmitter.join();
+
+    const FramePipeline<Ring>::Counters &counters = pipeline.getCounters();
+    const uint32_t wire_us = pipeline.getOutput().wireTimeUs();
+    std::printf("render %u us, transmit %u us per frame\n", render_us, wire_us);
+    std::printf("%-12s %8s %10s\n", "", "fps", "latency us");
+    // latency from the end of rendering to the end of the transmission
+    std::printf("%-12s %8.1f %10u\n", "sequential", sequential_frames * 1000.0 / run_ms,
+                sequential.getStats().scene(0).transmit.meanUs());
+    std::printf("%-12s %8.1f %10u\n", "pipelined", counters.transmitted * 1000.0 / run_ms,
+                counters.meanLatencyUs());
+
+    const bool whole_frames = untorn(pipeline.getOutput());
+    std::printf("frames %u stalls %u whole frames: %s\n", counters.transmitted, counters.stalls,
+                whole_frames ? "ok" : "FAILED");
+    return whole_frames ? 0 : 1;
+}
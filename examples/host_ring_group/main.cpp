@@ -0,0 +1,37 @@
+// Drives eight simulated rings from one PixelRingGroup and reports the aggregate frame time.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o host_ring_group
+
+#include <PixelRing.h>
+#include <PixelRingGroup.h>
+#include <cstdio>
+
+using Ring = PixelRing<60, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+
+int main()
+{
+    Ring r0, r1, r2, r3, r4, r5, r6, r7;
+    PixelRingGroup<Ring, Ring, Ring, Ring, Ring, Ring, Ring, Ring> group{ r0, r1, r2, r3,
+                                                                          r4, r5, r6, r7 };
+    group.setup();
+
+    // one scene per ring: White, Red, ..., Rainbow
+    Ring *rings[] = { &r0, &r1, &r2, &r3, &r4, &r5, &r6, &r7 };
+    for(uint8_t i = 0; i < group.size(); i++)
+    {
+        rings[i]->getStrip().recordFrames(false);
+        rings[i]->process(static_cast<Ring::SceneMode>(i + 1));
+    }
+
+    for(uint32_t ms = 0; ms < 10000; ms++)
+    {
+        HostClock::advance(1);
+        group.process();
+    }
+
+    const auto &frame_time = group.getFrameTime();
+    std::printf("rings: %u ticks: %u frames: %u mean: %u us max: %u us\n", group.size(),
+                frame_time.ticks, frame_time.frames, frame_time.meanFrameUs(),
+                frame_time.max_frame_us);
+    return 0;
+}
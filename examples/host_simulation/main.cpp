@@ -0,0 +1,66 @@
+// Runs every scene on a simulated strip and reports the render cost per frame as well as the
+// number of show() calls per scene, followed by the ring's own per scene stats.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o host_simulation
+
+#include <PixelRing.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using Ring = PixelRing<24, D0, NEO_GRB + NEO_KHZ400, HostBackend>;
+
+static const char *sceneName(Ring::SceneMode scene_mode)
+{
+    static const char *names[] = { "White",
+                                   "Red",
+                                   "Green",
+                                   "Blue",
+                                   "TheaterChaseWhite",
+                                   "TheaterChaseRed",
+                                   "TheaterChaseBlue",
+                                   "TheaterChaseRainbow",
+                                   "Rainbow",
+                                   "Off",
+                                   "Streaming",
+                                   "None" };
+    return names[static_cast<uint8_t>(scene_mode)];
+}
+
+int main()
+{
+    const uint32_t duration_ms = 10000;
+
+    Ring ring;
+    ring.setup();
+    ring.getStrip().recordFrames(false);
+
+    std::printf("%-20s %10s %10s %10s %12s\n", "scene", "calls", "shows", "skipped", "ns/call");
+    for(uint8_t s = 0; s < static_cast<uint8_t>(Ring::SceneMode::None); s++)
+    {
+        const Ring::SceneMode scene_mode = static_cast<Ring::SceneMode>(s);
+        ring.getStrip().resetFrames();
+        ring.resetFrameCounters();
+
+        std::chrono::nanoseconds elapsed{ 0 };
+        for(uint32_t ms = 0; ms < duration_ms; ms++)
+        {
+            HostClock::advance(1);
+            const auto start = std::chrono::steady_clock::now();
+            ring.process(scene_mode);
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+
+        std::printf("%-20s %10u %10u %10u %12.1f\n", sceneName(scene_mode), duration_ms,
+                    ring.getStrip().showCount(), ring.getFrameCounters().skipped,
+                    static_cast<double>(elapsed.count()) / duration_ms);
+    }
+
+    // per scene timing as recorded by the ring itself, render and transmit times in [us]
+    std::printf("\n");
+    HostBackend::log().stream = &std::cout;
+    ring.getStats().dump(HostBackend::log());
+    HostBackend::log().stream = nullptr;
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Streams Adalight frames through an in-memory stream into a ring, including frames with a bad
+// checksum and a truncated frame, checks the frames shown and reports the parser throughput.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o host_streaming
+
+#include <AdalightInput.h>
+#include <HostBenchmark.h>
+#include <PixelRing.h>
+#include <cstdio>
+
+using Ring = PixelRing<60, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+using Input = AdalightInput<HostStream, Ring>;
+
+//! Appends a frame of the given pixel count, each pixel r = i, g = seed, b = 255 - i.
+static void appendFrame(HostStream &stream, uint16_t pixels, uint8_t seed, bool corrupt = false)
+{
+    const uint8_t high = static_cast<uint8_t>((pixels - 1) >> 8);
+    const uint8_t low = static_cast<uint8_t>(pixels - 1);
+    const uint8_t header[] = { 'A', 'd', 'a', high, low,
+                               static_cast<uint8_t>(high ^ low ^ 0x55 ^ (corrupt ? 1 : 0)) };
+    stream.write(header, sizeof(header));
+    for(uint16_t i = 0; i < pixels; i++)
+    {
+        const uint8_t rgb[] = { static_cast<uint8_t>(i), seed, static_cast<uint8_t>(255 - i) };
+        stream.write(rgb, sizeof(rgb));
+    }
+}
+
+static bool shows(Ring &ring, uint8_t seed)
+{
+    for(uint16_t i = 0; i < Ring::led_count; i++)
+    {
+        if(ring.getStrip().getPixelColor(i) != HostStrip::Color(static_cast<uint8_t>(i), seed,
+                                                                 static_cast<uint8_t>(255 - i)))
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    Ring ring;
+    ring.setup();
+    HostStream stream;
+    Input input{ stream };
+    input.attach(ring);
+    ring.process(Ring::SceneMode::Streaming);
+
+    // a good frame, a corrupted one and another good one
+    appendFrame(stream, Ring::led_count, 1);
+    appendFrame(stream, Ring::led_count, 2, true);
+    appendFrame(stream, Ring::led_count, 3);
+
+    HostClock::advance(10);
+    ring.process();
+    const bool first = shows(ring, 1);
+    HostClock::advance(10);
+    ring.process();
+    const bool third = shows(ring, 3);
+
+    // a frame stalling halfway is dropped after the timeout, the next one is taken
+    stream.write(reinterpret_cast<const uint8_t *>("Ada"), 3);
+    HostClock::advance(10);
+    ring.process();
+    HostClock::advance(200);
+    ring.process();
+    appendFrame(stream, Ring::led_count, 4);
+    HostClock::advance(10);
+    ring.process();
+    const bool fourth = shows(ring, 4);
+
+    const Input::Counters &counters = input.getCounters();
+    std::printf("frames %u resyncs %u timeouts %u shows %u: %s\n", counters.frames,
+                counters.resyncs, counters.timeouts, ring.getStrip().showCount(),
+                (first && third && fourth) ? "ok" : "FAILED");
+
+    // throughput of the parser alone, frames queued up front
+    const uint32_t frames = 20000;
+    HostStream bulk;
+    for(uint32_t f = 0; f < frames; f++)
+        appendFrame(bulk, Ring::led_count, static_cast<uint8_t>(f));
+    Input bulk_input{ bulk };
+    uint32_t received = 0;
+    const uint32_t bytes = static_cast<uint32_t>(bulk.bytes.size());
+    const double ns_per_byte = HostBenchmark::nsPer(bytes, [&bulk_input, &ring, &received]() {
+        while(bulk_input.receive(ring.getStrip().getPixels(), 200))
+            ++received;
+    });
+    std::printf("parsed %u frames, %.2f ns/byte, %.1f MB/s\n", received, ns_per_byte,
+                1000.0 / ns_per_byte);
+
+    return (first && third && fourth && received == frames) ? 0 : 1;
+}
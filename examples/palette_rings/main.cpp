@@ -0,0 +1,105 @@
+// Drives three 300 pixel palette rings, one on an output of its own and two sharing a multiplexed
+// output, and compares RAM and time per rainbow frame with PixelRing. Checks that each transmitted
+// pixel is its palette color on the pin of its ring, wrt. to brightness and arc.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o palette_rings
+
+#include <HostBenchmark.h>
+#include <PaletteRing.h>
+#include <PixelRingGroup.h>
+#include <cstdio>
+
+static const uint16_t led_count = 300;
+static const uint32_t frames = 5000;
+
+using Output = PaletteOutput<led_count, 1, NEO_GRB + NEO_KHZ800, HostBackend>;
+//! needs a pull-down on each data line, see MultiplexedPaletteOutput
+using SharedOutput = MultiplexedPaletteOutput<led_count, NEO_GRB + NEO_KHZ800, HostBackend>;
+using Ring = PaletteRing<led_count, 1, Output>;
+using Ring2 = PaletteRing<led_count, 2, SharedOutput>;
+using Ring3 = PaletteRing<led_count, 3, SharedOutput>;
+using FullRing = PixelRing<led_count, 1, NEO_GRB + NEO_KHZ800, HostBackend>;
+
+//! \return time per frame of the ring's current scene in [ns]
+template <typename R> static double nsPerFrame(R &ring)
+{
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = 10;
+
+    return HostBenchmark::nsPer(frames, [&ring, &tick]() {
+        for(uint32_t f = 0; f < frames; f++)
+        {
+            ring.render(tick);
+            ring.flush();
+        }
+    });
+}
+
+//! \return true if the last frame transmitted equals the frame of the ring, wrt. to brightness
+//! and arc
+template <typename R, typename O> static bool transmitted(R &ring, O &output)
+{
+    const HostStrip &strip = output.getStrip();
+    if(strip.getFrames().empty() || strip.getPin() != R::led_pin)
+        return false;
+
+    const std::vector<uint8_t> &pixels = strip.getFrames().back().pixels;
+    const uint16_t scale = BrightnessScale::fromPercent(ring.getBrightness(), ring.isOn());
+    const RingState state = ring.getState();
+    const uint16_t width = (state.arc_end + R::led_count - state.arc_begin) % R::led_count;
+    for(uint16_t pixel = 0; pixel < R::led_count; pixel++)
+    {
+        const bool within_arc = (pixel + R::led_count - state.arc_begin) % R::led_count <= width;
+        uint8_t expected[3] = {};
+        if(within_arc)
+            O::Pixels::encode(BrightnessScale::apply(ring.getFrame().color(pixel), scale),
+                              expected);
+        if(memcmp(&pixels[pixel * 3], expected, 3) != 0)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    Output output;
+    SharedOutput shared;
+    Ring a{ output };
+    Ring2 b{ shared };
+    Ring3 c{ shared };
+    PixelRingGroup<Ring, Ring2, Ring3> group{ a, b, c };
+    group.setup();
+    b.setScene<PaletteChaseRedScene>();
+    c.post(Ring3::Command::Kind::Brightness, -20);
+    c.setArc(250, 100);
+
+    bool ok = true;
+    for(uint32_t ms = 0; ms < 1000; ms++)
+    {
+        HostClock::advance(1);
+        group.process();
+        // the shared output holds the frame of the ring transmitted last
+        ok = ok && (a.getFrameCounters().emitted == 0 || transmitted(a, output)) &&
+             (c.getFrameCounters().emitted == 0 || transmitted(c, shared));
+    }
+    output.getStrip().recordFrames(false);
+    shared.getStrip().recordFrames(false);
+
+    // RAM of three rings: palette rings keep indices and palette, the outputs a strip buffer each
+    const uint32_t palette_ram = 3 * (sizeof(Ring) + sizeof(Output) + led_count * 3);
+    const uint32_t shared_ram = 3 * sizeof(Ring) + sizeof(SharedOutput) + led_count * 3;
+    const uint32_t full_ram = 3 * (sizeof(FullRing) + led_count * 3);
+    std::printf("%-28s %12s %14s\n", "", "ns/frame", "RAM x3 rings");
+    std::printf("%-28s %12.1f %14u\n", "PaletteRing rainbow", nsPerFrame(a), palette_ram);
+    std::printf("%-28s %12s %14u\n", "  on a multiplexed output", "", shared_ram);
+
+    FullRing full;
+    full.setup();
+    full.getStrip().recordFrames(false);
+    std::printf("%-28s %12.1f %14u\n", "PixelRing rainbow", nsPerFrame(full), full_ram);
+
+    std::printf("frames %u %u %u transmitted as rendered: %s\n", a.getFrameCounters().emitted,
+                b.getFrameCounters().emitted, c.getFrameCounters().emitted, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+// Simulates boots of a ring keeping its state in a file. The first boot changes the scene,
+// brightness and arc (twenty brightness steps in a row among them) and runs for a while; the
+// second boot restores the state and checks that it is shown by its very first transmission. A
+// third boot with another scene list does not take the state over.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o persistent_state
+
+#include <EffectScenes.h>
+#include <PixelRing.h>
+#include <cstdio>
+
+using Ring = PixelRing<24, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+using Store = StateStore<HostFileStorage>;
+
+static void run(Ring &ring, uint32_t ms)
+{
+    for(uint32_t i = 0; i < ms; i++)
+    {
+        HostClock::advance(1);
+        ring.process();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : "persistent_state.bin";
+    std::remove(path);
+
+    // first boot: nothing stored yet
+    RingState saved;
+    uint32_t writes = 0;
+    {
+        HostFileStorage storage{ path };
+        Store store{ storage };
+        Ring ring;
+        const bool restored = store.attach(ring);
+        ring.setup();
+        std::printf("boot 1: restored %s\n", restored ? "yes" : "no");
+
+        ring.process(Ring::SceneMode::Rainbow);
+        for(uint8_t i = 0; i < 20; i++)
+        {
+            ring.incrementBrightness((i % 2) ? 5 : -7);
+            run(ring, 10);
+        }
+        ring.incrementWidth(-6);
+        ring.shift(3);
+
+        // the write happens once the settings were stable for the debounce time (5 s)
+        run(ring, 8000);
+        writes = storage.writes;
+        saved = ring.getState();
+        std::printf("boot 1: 22 changes, %u write(s) of %u bytes, brightness %u %%\n", writes,
+                    store.size, ring.getBrightness());
+    }
+
+    // second boot: the state is restored and shown by a single transmission
+    HostFileStorage storage{ path };
+    Store store{ storage };
+    Ring ring;
+    const bool restored = store.attach(ring);
+    ring.setup();
+
+    const HostStrip &strip = ring.getStrip();
+    const bool single = strip.showCount() == 1;
+    const bool same = ring.getState().sameSettings(saved);
+    std::printf("boot 2: restored %s, scene %u, brightness %u %%, transmissions %u\n",
+                restored ? "yes" : "no", ring.getScene(), ring.getBrightness(),
+                strip.showCount());
+
+    run(ring, 1000);
+    std::printf("boot 2: %u write(s) after a second unchanged\n", storage.writes);
+
+    // third boot: a firmware with other scenes, the scene stored would be another one
+    PixelRing<24, D0, NEO_GRB + NEO_KHZ800, HostBackend, EffectScenes> effects;
+    const bool foreign = store.attach(effects);
+    std::printf("boot 3: other scene list, restored %s\n", foreign ? "yes" : "no");
+
+    const bool ok = restored && writes == 1 && single && same && storage.writes == 0 && !foreign;
+    std::printf("state as before the reset: %s\n", ok ? "ok" : "FAILED");
+    std::remove(path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// Runs every scene for a fixed number of frames on PixelRing instances of 16 to 1024 RGB and RGBW
+// pixels and prints one CSV line per ring and scene: time per frame and per pixel, frames emitted
+// and the RAM of an instance (the ring plus its strip buffer).
+//
+// Given a CSV of a previous run, each ns_per_frame is compared with it and the exit code is 1 if
+// any exceeds its baseline by more than the tolerance (default 10 %), i.e. to gate releases.
+// Each time is the fastest of several repetitions, still, compare runs of the same quiet machine
+// (fixed CPU frequency, nothing else running):
+//
+//     ./scene_benchmark > baseline.csv
+//     ./scene_benchmark baseline.csv 15
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o scene_benchmark
+
+#include <HostBenchmark.h>
+#include <PixelRing.h>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+//! frames per repetition, the fastest of the repetitions counts
+static const uint32_t frames = 1000;
+static const uint8_t repetitions = 20;
+
+static const char *scene_names[] = { "White",
+                                     "Red",
+                                     "Green",
+                                     "Blue",
+                                     "TheaterChaseWhite",
+                                     "TheaterChaseRed",
+                                     "TheaterChaseBlue",
+                                     "TheaterChaseRainbow",
+                                     "Rainbow",
+                                     "Off",
+                                     "Streaming" };
+
+//! ns_per_frame of a previous run by "led_count,led_type,scene"
+using Baseline = std::map<std::string, double>;
+
+static Baseline readBaseline(const char *path)
+{
+    Baseline baseline;
+    FILE *file = std::fopen(path, "r");
+    if(!file)
+    {
+        std::fprintf(stderr, "cannot read %s\n", path);
+        std::exit(2);
+    }
+
+    char line[256];
+    while(std::fgets(line, sizeof(line), file))
+    {
+        unsigned led_count;
+        char led_type[16], scene[32];
+        double ns_per_frame;
+        if(std::sscanf(line, "%u,%15[^,],%31[^,],%*u,%*u,%lf", &led_count, led_type, scene,
+                       &ns_per_frame) == 4)
+            baseline[std::to_string(led_count) + "," + led_type + "," + scene] = ns_per_frame;
+    }
+    std::fclose(file);
+    return baseline;
+}
+
+template <uint16_t LED_COUNT, neoPixelType LED_TYPE>
+static void run(const char *type_name,
+                const Baseline &baseline,
+                double tolerance,
+                bool &regressed)
+{
+    using Ring = PixelRing<LED_COUNT, D0, LED_TYPE + NEO_KHZ800, HostBackend>;
+    const uint32_t ram = sizeof(Ring) + LED_COUNT * Ring::bytes_per_pixel;
+
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = 10;
+
+    for(uint8_t s = 0; s < static_cast<uint8_t>(Ring::SceneMode::None); s++)
+    {
+        Ring ring;
+        ring.setup();
+        ring.getStrip().recordFrames(false);
+        ring.setScene(s);
+
+        const double ns_per_frame = HostBenchmark::nsPer(
+        frames,
+        [&ring, &tick]() {
+            for(uint32_t f = 0; f < frames; f++)
+            {
+                ring.render(tick);
+                ring.flush();
+            }
+        },
+        repetitions);
+
+        const std::string key =
+        std::to_string(LED_COUNT) + "," + type_name + "," + scene_names[s];
+        std::printf("%s,%u,%u,%.1f,%.3f,%u", key.c_str(), frames * repetitions,
+                    ring.getFrameCounters().emitted, ns_per_frame, ns_per_frame / LED_COUNT, ram);
+
+        const Baseline::const_iterator previous = baseline.find(key);
+        if(previous != baseline.end())
+        {
+            const double change = ns_per_frame / previous->second - 1;
+            const bool slower = change > tolerance;
+            regressed = regressed || slower;
+            std::printf(",%+.1f%%,%s", change * 100, slower ? "REGRESSED" : "ok");
+        }
+        std::printf("\n");
+    }
+}
+
+template <neoPixelType LED_TYPE>
+static void runAll(const char *type_name, const Baseline &baseline, double tolerance,
+                   bool &regressed)
+{
+    run<16, LED_TYPE>(type_name, baseline, tolerance, regressed);
+    run<24, LED_TYPE>(type_name, baseline, tolerance, regressed);
+    run<60, LED_TYPE>(type_name, baseline, tolerance, regressed);
+    run<144, LED_TYPE>(type_name, baseline, tolerance, regressed);
+    run<300, LED_TYPE>(type_name, baseline, tolerance, regressed);
+    run<1024, LED_TYPE>(type_name, baseline, tolerance, regressed);
+}
+
+int main(int argc, char **argv)
+{
+    const Baseline baseline = (argc > 1) ? readBaseline(argv[1]) : Baseline{};
+    const double tolerance = ((argc > 2) ? std::atof(argv[2]) : 10.0) / 100;
+    bool regressed = false;
+
+    std::printf("led_count,led_type,scene,frames,emitted,ns_per_frame,ns_per_pixel,ram_bytes%s\n",
+                baseline.empty() ? "" : ",change,status");
+    runAll<NEO_GRB>("GRB", baseline, tolerance, regressed);
+    runAll<NEO_GRBW>("GRBW", baseline, tolerance, regressed);
+    return regressed ? 1 : 0;
+}
@@ -1,6 +1,8 @@
 #include <PixelRing.h>
 
-PixelRing<24> strip;
+using Ring = PixelRing<24>;
+
+Ring strip;
 
 void setup()
 {
@@ -11,5 +13,5 @@ void setup()
 
 void loop()
 {
-   strip.process(SceneMode scene_mode = SceneMode::Rainbow);
+    strip.process(Ring::SceneMode::Rainbow);
 }
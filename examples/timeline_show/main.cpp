@@ -0,0 +1,165 @@
+// Compiles a show from its text form, validates it against the ring, prints it as the C array a
+// sketch would keep in flash and plays it on a simulated ring. Checks that seeking to any position
+// yields the very values continuous playback had there, and that malformed shows are rejected.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o timeline_show
+
+#include <PixelRing.h>
+#include <Timeline.h>
+#include <TimelineCompiler.h>
+#include <chrono>
+#include <cstdio>
+
+using Ring = PixelRing<24, D0, NEO_GRB + NEO_KHZ800, HostBackend>;
+
+static const uint8_t scene_count = static_cast<uint8_t>(Ring::SceneMode::None);
+
+static const char *const show_text = R"(# sunrise, then a chase narrowing down
+loop
+key hold 1000 scene Rainbow brightness 10 arc 0 24 color ff4000
+key ramp 3000 ease in-out hold 1000 brightness 100 color ffffff
+key ramp 500 ease out scene TheaterChaseRainbow arc 6 12
+key ramp 2000 ease in arc 18 4 hold 500
+key ramp 1000 brightness 10 arc 0 24
+)";
+
+//! a loop whose first keyframe leaves values unset, the rounds after the first start from the
+//! values the previous round ended with rather than the ones of the ring
+static const char *const partial_loop_text = R"(loop
+key hold 1000 brightness 30
+key ramp 1000 hold 1000 arc 5 10 color ff0000
+)";
+
+static bool sameValues(const TimelineValues &a, const TimelineValues &b)
+{
+    return a.scene == b.scene && a.brightness == b.brightness && a.color == b.color &&
+           a.arc_begin == b.arc_begin && a.arc_width == b.arc_width;
+}
+
+//! Plays the show continuously on the ring, the values are sampled each 100 ms.
+static std::vector<TimelineValues> sample(Ring &ring, const std::vector<uint8_t> &show,
+                                          uint32_t duration_ms,
+                                          std::chrono::nanoseconds &update_time)
+{
+    Timeline<Ring> timeline{ ring };
+    timeline.load(show.data(), show.size());
+    timeline.play(HostClock::millis());
+
+    std::vector<TimelineValues> samples;
+    for(uint32_t ms = 0; ms < duration_ms; ms++)
+    {
+        if(ms % 100 == 0)
+            samples.push_back(timeline.values());
+        HostClock::advance(1);
+        const auto start = std::chrono::steady_clock::now();
+        timeline.update(HostClock::millis());
+        update_time += std::chrono::steady_clock::now() - start;
+        ring.process();
+    }
+    return samples;
+}
+
+//! \return true if seeking to each sample on another ring yields the values sampled
+static bool seeksMatch(const std::vector<uint8_t> &show, const std::vector<TimelineValues> &samples)
+{
+    Ring other;
+    other.setup();
+    Timeline<Ring> seeking{ other };
+    seeking.load(show.data(), show.size());
+    seeking.play(HostClock::millis());
+    bool seeks = true;
+    for(size_t i = samples.size(); i-- > 0;)
+    {
+        seeking.seek(static_cast<uint32_t>(i * 100));
+        seeks = seeks && sameValues(seeking.values(), samples[i]) &&
+                other.getBrightness() == samples[i].brightness &&
+                other.getScene() == samples[i].scene;
+    }
+    return seeks;
+}
+
+//! \return true if the malformed show is rejected by the compiler or the validator
+static bool rejected(const char *text)
+{
+    TimelineCompiler compiler{ { "White", "Red" } };
+    std::vector<uint8_t> program;
+    std::string error;
+    const bool valid = compiler.compile(text, program) &&
+                       TimelineValidator::validate(program.data(), program.size(), scene_count,
+                                                   Ring::led_count, error);
+    std::string line{ text };
+    for(char &c : line)
+        c = (c == '\n') ? ';' : c;
+    std::printf("  %-32s %s\n", line.c_str(),
+                valid ? "accepted" : (error.empty() ? compiler.error() : error).c_str());
+    return !valid;
+}
+
+int main()
+{
+    TimelineCompiler compiler{ { "White",
+                                 "Red",
+                                 "Green",
+                                 "Blue",
+                                 "TheaterChaseWhite",
+                                 "TheaterChaseRed",
+                                 "TheaterChaseBlue",
+                                 "TheaterChaseRainbow",
+                                 "Rainbow",
+                                 "Off",
+                                 "Streaming" } };
+    std::vector<uint8_t> show;
+    std::string error;
+    if(!compiler.compile(show_text, show) ||
+       !TimelineValidator::validate(show.data(), show.size(), scene_count, Ring::led_count, error))
+    {
+        std::printf("show rejected: %s%s\n", compiler.error().c_str(), error.c_str());
+        return 1;
+    }
+    std::printf("%zu bytes of text compiled into %zu bytes:\n%s", std::string(show_text).size(),
+                show.size(), TimelineCompiler::source("show", show).c_str());
+
+    // continuous playback over two rounds, then seeking to each sample on a second ring
+    Ring ring;
+    ring.setup();
+    std::chrono::nanoseconds update_time{ 0 };
+    const std::vector<TimelineValues> samples = sample(ring, show, 16000, update_time);
+    std::printf("%u frames, %.1f ns per update, brightness at 2.5 s %u %%, arc at 6 s %u+%u\n",
+                ring.getFrameCounters().emitted, static_cast<double>(update_time.count()) / 16000,
+                samples[25].brightness, samples[60].arc_begin, samples[60].arc_width);
+    const bool seeks = seeksMatch(show, samples);
+    std::printf("seeking matches playback: %s\n", seeks ? "ok" : "FAILED");
+
+    std::vector<uint8_t> partial_loop;
+    Ring partial;
+    partial.setup();
+    const bool partial_seeks = compiler.compile(partial_loop_text, partial_loop) &&
+                               seeksMatch(partial_loop, sample(partial, partial_loop, 10000,
+                                                                update_time));
+    std::printf("seeking matches playback of a loop with values unset at first: %s\n",
+                partial_seeks ? "ok" : "FAILED");
+
+    std::printf("malformed shows:\n");
+    const bool rejects = rejected("key hold 100 brightness 120") &&
+                         rejected("key hold 1 scene Pink") && rejected("key hold 1 scene 40") &&
+                         rejected("key arc 30 4") && rejected("loop\nkey scene Red") &&
+                         rejected("key hold 70000") && rejected("key color orange") &&
+                         rejected("hold 100");
+
+    // a corrupt program is detected rather than read beyond its end
+    std::vector<uint8_t> truncated(show.begin(), show.end() - 3);
+    const bool detects = !TimelineValidator::validate(truncated.data(), truncated.size(),
+                                                      scene_count, Ring::led_count, error);
+    Timeline<Ring> corrupt{ ring };
+    corrupt.load(truncated.data(), truncated.size());
+    corrupt.play(HostClock::millis());
+    // the last keyframe is cut off
+    corrupt.seek(8500);
+    std::printf("truncated program: %s, played %s\n", error.c_str(),
+                (corrupt.status() == Timeline<Ring>::Status::Invalid) ? "invalid" : "FAILED");
+
+    const bool ok = seeks && partial_seeks && rejects && detects &&
+                    corrupt.status() == Timeline<Ring>::Status::Invalid;
+    std::printf("timeline: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Compares compositing a rainbow through Strip::setPixelColor(), which looks up the channel order
+// at runtime per pixel, with writing it straight into the strip buffer by means of PixelSpan, for
+// RGB and RGBW strips. Also checks both write the same bytes. HostStrip::setPixelColor() is inlined
+// here, on a device the call into Adafruit_NeoPixel adds to the difference.
+//
+// build: g++ -std=c++11 -O2 -I../../src main.cpp -o wire_order_benchmark
+
+#include <HostBenchmark.h>
+#include <PixelRing.h>
+#include <cstdio>
+#include <cstring>
+
+static const uint16_t led_count = 300;
+
+//! \return true if both ways write the same bytes
+template <neoPixelType LED_TYPE> static bool compare(const char *name, uint32_t frames)
+{
+    using Span = PixelSpan<LED_TYPE>;
+    Compositor<led_count> layers;
+    layers.addArc(250, 200);
+    layers.addOverlay(10, 20, HostStrip::Color(0, 0, 64, 32), BlendMode::Add);
+
+    uint16_t first_hue = 0;
+    auto rainbow = [&first_hue](uint16_t pixel) -> uint32_t {
+        return HueGammaTable::color(
+        static_cast<uint16_t>(first_hue + HueOffsetTable<led_count>::get(pixel)));
+    };
+
+    HostStrip per_pixel{ led_count, D0, LED_TYPE };
+    const double set_pixel_color = HostBenchmark::nsPer(frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+        {
+            first_hue = static_cast<uint16_t>(f * 256);
+            layers.compose(per_pixel, rainbow);
+        }
+    });
+
+    HostStrip direct{ led_count, D0, LED_TYPE };
+    const double wire_order = HostBenchmark::nsPer(frames, [&]() {
+        for(uint32_t f = 0; f < frames; f++)
+        {
+            first_hue = static_cast<uint16_t>(f * 256);
+            layers.template composePixels<Span>(direct.getPixels(), rainbow);
+        }
+    });
+
+    std::printf("%-28s %10.1f %10.1f\n", name, set_pixel_color, wire_order);
+    return std::memcmp(per_pixel.getPixels(), direct.getPixels(),
+                       led_count * Span::bytes_per_pixel) == 0;
+}
+
+int main()
+{
+    const uint32_t frames = 20000;
+
+    std::printf("%-28s %10s %10s\n", "ns/frame, 300 pixels", "setPixel", "wire order");
+    bool same = compare<NEO_GRB + NEO_KHZ800>("GRB", frames);
+    same = compare<NEO_RGB + NEO_KHZ800>("RGB", frames) && same;
+    same = compare<NEO_GRBW + NEO_KHZ800>("GRBW", frames) && same;
+    same = compare<NEO_WRGB + NEO_KHZ800>("WRGB", frames) && same;
+    std::printf("same bytes: %s\n", same ? "ok" : "FAILED");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Receives pixels in the Adalight protocol from a byte stream, i.e. a PC streaming frames over
+//! the serial port. Each frame is
+//!
+//!     'A' 'd' 'a' count_high count_low checksum r g b r g b ...
+//!
+//! with count + 1 pixels and checksum = count_high ^ count_low ^ 0x55. Bytes are parsed as they
+//! arrive, straight into the strip buffer in wire order and scaled by the brightness on the way.
+//! Frames with a bad checksum or stalling longer than the timeout are dropped and the parser
+//! waits for the next 'Ada'. Pixels beyond the strip are discarded, pixels not sent are kept.
+//!
+//!     AdalightInput<HardwareSerial, Ring> input{ Serial };
+//!     input.attach(ring);
+//!     ring.setScene<StreamScene>();
+//!
+//! \tparam Stream provides int available() and int read(), i.e. an Arduino Stream or HostStream
+//! \tparam Ring the PixelRing type received for
+template <typename Stream, typename Ring> class AdalightInput
+{
+public:
+    struct Counters
+    {
+        //! frames received completely
+        uint32_t frames{ 0 };
+        //! bytes read in total
+        uint32_t bytes{ 0 };
+        //! frames dropped due to a bad checksum
+        uint32_t resyncs{ 0 };
+        //! frames dropped since stalled
+        uint32_t timeouts{ 0 };
+        //! time from the first header byte to the last pixel byte of the last frame in [us]
+        uint32_t last_latency_us{ 0 };
+        uint32_t max_latency_us{ 0 };
+        uint64_t total_latency_us{ 0 };
+
+        uint32_t meanLatencyUs() const
+        {
+            return frames ? static_cast<uint32_t>(total_latency_us / frames) : 0;
+        }
+    };
+
+    explicit AdalightInput(Stream &stream) : stream(stream) {}
+
+    //! Makes the ring read its pixels from this input, see StreamScene.
+    void attach(Ring &ring) { ring.setPixelInput(&AdalightInput::receive, this); }
+
+    //! Sends the 'Ada' greeting host software waits for before streaming.
+    void greet()
+    {
+        const char greeting[] = "Ada\n";
+        for(uint8_t i = 0; i < sizeof(greeting) - 1; i++)
+            stream.write(static_cast<uint8_t>(greeting[i]));
+    }
+
+    //! \param timeout_ms time a frame may stall before it is dropped
+    void setTimeout(uint16_t timeout_ms) { timeout = timeout_ms; }
+
+    //! Parses the bytes available, up to the end of the next frame.
+    //! \param pixels strip buffer
+    //! \param scale brightness scale 0-256 applied to each byte
+    //! \return true if a frame was completed
+    bool receive(uint8_t *pixels, uint16_t scale);
+
+    //! Pixel input as of PixelRing::setPixelInput().
+    static bool receive(void *input, uint8_t *pixels, uint16_t scale)
+    {
+        return static_cast<AdalightInput *>(input)->receive(pixels, scale);
+    }
+
+    const Counters &getCounters() const { return counters; }
+
+    void resetCounters() { counters = Counters{}; }
+
+private:
+    enum class State : uint8_t
+    {
+        A,
+        D,
+        SecondA,
+        CountHigh,
+        CountLow,
+        Checksum,
+        Pixels
+    };
+
+    using Backend = typename Ring::BackendType;
+
+    using Pixels = typename Ring::Pixels;
+
+    //! \return byte offset of the channel (0 red, 1 green, 2 blue) within a pixel in wire order
+    static constexpr uint8_t offset(uint8_t channel)
+    {
+        return (channel == 0) ? static_cast<uint8_t>(Pixels::red_offset) :
+               (channel == 1) ? static_cast<uint8_t>(Pixels::green_offset) :
+                                static_cast<uint8_t>(Pixels::blue_offset);
+    }
+
+    //! \return true if the byte completed a frame
+    bool parse(uint8_t byte, uint8_t *pixels, uint16_t scale);
+
+    Stream &stream;
+    Counters counters;
+    uint32_t frame_start_us{ 0 };
+    uint32_t last_byte_ms{ 0 };
+    uint16_t timeout{ 100 };
+    //! pixels of the current frame
+    uint16_t count{ 0 };
+    uint16_t pixel{ 0 };
+    uint8_t channel{ 0 };
+    uint8_t count_high{ 0 };
+    uint8_t count_low{ 0 };
+    State state{ State::A };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Stream, typename Ring>
+bool AdalightInput<Stream, Ring>::receive(uint8_t *pixels, uint16_t scale)
+{
+    if(state != State::A && Backend::millis() - last_byte_ms > timeout)
+    {
+        ++counters.timeouts;
+        state = State::A;
+    }
+
+    while(stream.available() > 0)
+    {
+        const int value = stream.read();
+        if(value < 0)
+            break;
+
+        ++counters.bytes;
+        last_byte_ms = Backend::millis();
+        if(parse(static_cast<uint8_t>(value), pixels, scale))
+            return true;
+    }
+    return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Stream, typename Ring>
+bool AdalightInput<Stream, Ring>::parse(uint8_t byte, uint8_t *pixels, uint16_t scale)
+{
+    switch(state)
+    {
+    case State::A:
+        if(byte == 'A')
+        {
+            frame_start_us = Backend::micros();
+            state = State::D;
+        }
+        break;
+    case State::D:
+        state = (byte == 'd') ? State::SecondA : (byte == 'A') ? State::D : State::A;
+        break;
+    case State::SecondA:
+        state = (byte == 'a') ? State::CountHigh : State::A;
+        break;
+    case State::CountHigh:
+        count_high = byte;
+        state = State::CountLow;
+        break;
+    case State::CountLow:
+        count_low = byte;
+        state = State::Checksum;
+        break;
+    case State::Checksum:
+        if(byte != (count_high ^ count_low ^ 0x55))
+        {
+            ++counters.resyncs;
+            state = State::A;
+            break;
+        }
+        count = static_cast<uint16_t>(((count_high << 8) | count_low) + 1);
+        pixel = 0;
+        channel = 0;
+        state = State::Pixels;
+        break;
+    case State::Pixels:
+        if(pixel < Ring::led_count)
+        {
+            uint8_t *target = &pixels[pixel * Pixels::bytes_per_pixel];
+            target[offset(channel)] = static_cast<uint8_t>((byte * scale) >> 8);
+            if(Pixels::bytes_per_pixel == 4)
+                target[Pixels::white_offset] = 0;
+        }
+
+        if(++channel < 3)
+            break;
+
+        channel = 0;
+        if(++pixel < count)
+            break;
+
+        const uint32_t latency_us = Backend::micros() - frame_start_us;
+        counters.last_latency_us = latency_us;
+        counters.max_latency_us =
+        (latency_us > counters.max_latency_us) ? latency_us : counters.max_latency_us;
+        counters.total_latency_us += latency_us;
+        ++counters.frames;
+        state = State::A;
+        return true;
+    }
+    return false;
+}
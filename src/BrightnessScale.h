@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Fixed point brightness scaling: a scale of 256 leaves colors untouched, 0 turns them off.
+//! Colors are scaled SWAR-wise, two 8 bit channels per 32 bit multiplication.
+struct BrightnessScale
+{
+    static constexpr uint16_t max_scale = 256;
+
+    //! \param percent brightness 0-100 [%]
+    //! \param on false forces the scale to 0
+    //! \return scale 0-256
+    static constexpr uint16_t fromPercent(uint8_t percent, bool on)
+    {
+        return on ? static_cast<uint16_t>((percent * 256U + 50) / 100) : 0;
+    }
+
+    //! \return brightness after incrementing it by maximum +/-20 %, capped to 5-100 [%]
+    static uint8_t stepPercent(uint8_t percent, int8_t increment)
+    {
+        const int8_t max_step = 20;
+        auto cap = [](int8_t &value, int8_t min, int8_t max) {
+            value = (value > max) ? max : value;
+            value = (value < min) ? min : value;
+            return value;
+        };
+
+        cap(increment, -max_step, max_step);
+
+        int8_t new_percent = static_cast<int8_t>(percent);
+        new_percent += increment;
+        cap(new_percent, 5, 100);
+        return static_cast<uint8_t>(new_percent);
+    }
+
+    //! Scales all four channels of a packed 0xWWRRGGBB color.
+    static uint32_t apply(uint32_t color, uint16_t scale)
+    {
+        // channels 0 and 2 (blue and red) are 16 bit apart and do not overflow into each other
+        uint32_t rb = (((color & 0x00ff00ff) * scale) >> 8) & 0x00ff00ff;
+        // same for channels 1 and 3 (green and white)
+        uint32_t wg = (((color >> 8) & 0x00ff00ff) * scale) & 0xff00ff00;
+        return wg | rb;
+    }
+
+    //! Scales every byte of the given (i.e. strip-) buffer in place. The channel order is
+    //! irrelevant since all channels are scaled alike.
+    static void apply(uint8_t *buffer, uint16_t size, uint16_t scale)
+    {
+        if(scale >= max_scale)
+            return;
+
+        uint16_t i = 0;
+        for(; i + 4 <= size; i += 4)
+        {
+            uint32_t word;
+            memcpy(&word, &buffer[i], 4);
+            word = apply(word, scale);
+            memcpy(&buffer[i], &word, 4);
+        }
+
+        for(; i < size; i++)
+            buffer[i] = static_cast<uint8_t>((buffer[i] * scale) >> 8);
+    }
+};
@@ -1,25 +1,70 @@
 #pragma once
 
+#include <stdint.h>
+
 //--------------------------------------------------------------------------------------------------
 
-template <uint16_t MAX> struct CappedNumber
+//! Wraps values into [0, MAX): by masking if MAX is a power of two, by compare and subtract
+//! otherwise.
+template <uint16_t MAX, bool POWER_OF_TWO = (MAX & (MAX - 1)) == 0> struct CappedNumberWrap
 {
-    CappedNumber(const CappedNumber &other)
+    //! \return val modulo MAX
+    static constexpr uint16_t reduce(uint16_t val) { return val % MAX; }
+
+    //! \return (value + delta) modulo MAX
+    //! \param value within [0, MAX)
+    static constexpr uint16_t add(uint16_t value, int32_t delta)
+    {
+        return wrap(static_cast<uint32_t>(value) + offset(delta));
+    }
+
+private:
+    //! \return value - MAX if value exceeds [0, MAX)
+    //! \param value within [0, 2 * MAX)
+    static constexpr uint16_t wrap(uint32_t value)
+    {
+        return static_cast<uint16_t>((value >= MAX) ? value - MAX : value);
+    }
+
+    //! \return delta modulo MAX within [0, MAX), without a division for deltas within +/- MAX
+    static constexpr uint32_t offset(int32_t delta)
     {
-        value = other.value;
-        trim();
+        return (delta >= 0) ?
+               ((delta < MAX) ? static_cast<uint32_t>(delta) : static_cast<uint32_t>(delta % MAX)) :
+               ((delta >= -MAX) ? static_cast<uint32_t>(MAX + delta) :
+                                  static_cast<uint32_t>(MAX - 1 - (-(delta + 1)) % MAX));
     }
-    CappedNumber(uint16_t val)
+};
+
+template <uint16_t MAX> struct CappedNumberWrap<MAX, true>
+{
+    static constexpr uint16_t reduce(uint16_t val) { return val & (MAX - 1); }
+
+    static constexpr uint16_t add(uint16_t value, int32_t delta)
     {
-        value = val;
-        trim();
+        // two's complement makes negative deltas wrap alike
+        return static_cast<uint16_t>((value + static_cast<uint32_t>(delta)) & (MAX - 1));
     }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Number within [0, MAX) which wraps around on over- and underflow, i.e. a pixel index on a ring.
+template <uint16_t MAX> struct CappedNumber
+{
+    static_assert(MAX > 0, "MAX must not be 0");
+
+    using Wrap = CappedNumberWrap<MAX>;
+
+    constexpr CappedNumber(const CappedNumber &other) = default;
+
+    constexpr CappedNumber(uint16_t val) : value(Wrap::reduce(val)) {}
 
     //----------------------------------------------------------------------------------------------
 
     CappedNumber &operator++()
     {
-        operator+=(1);
+        value = Wrap::add(value, 1);
         return *this;
     }
 
@@ -27,7 +72,7 @@ template <uint16_t MAX> struct CappedNumber
 
     CappedNumber &operator--()
     {
-        operator-=(1);
+        value = Wrap::add(value, -1);
         return *this;
     }
 
@@ -35,8 +80,8 @@ template <uint16_t MAX> struct CappedNumber
 
     CappedNumber operator++(int)
     {
-        CappedNumber temp{ value };
-        operator+=(1);
+        CappedNumber temp{ *this };
+        operator++();
         return temp;
     }
 
@@ -44,122 +89,94 @@ template <uint16_t MAX> struct CappedNumber
 
     CappedNumber operator--(int)
     {
-        CappedNumber temp{ value };
-        operator-=(1);
+        CappedNumber temp{ *this };
+        operator--();
         return temp;
     }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber operator+(uint16_t sum) { return { value + sum }; }
+    constexpr CappedNumber operator+(uint16_t sum) const
+    {
+        return CappedNumber{ Wrap::add(value, sum), Reduced{} };
+    }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber operator-(uint16_t sum)
+    constexpr CappedNumber operator-(uint16_t sum) const
     {
-        CappedNumber temp{ value };
-        temp -= sum; // handle potential underflow with care
-        return temp;
+        return CappedNumber{ Wrap::add(value, -static_cast<int32_t>(sum)), Reduced{} };
     }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber operator+(const CappedNumber &other)
+    constexpr CappedNumber operator+(const CappedNumber &other) const
     {
-        this->operator+(other.value);
-        return *this;
+        return operator+(other.value);
     }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber operator-(const CappedNumber &other)
+    constexpr CappedNumber operator-(const CappedNumber &other) const
     {
-        this->operator-(other.value);
-        return *this;
+        return operator-(other.value);
     }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber &operator=(const CappedNumber &other)
-    {
-        this->operator=(other.value);
-        return *this;
-    }
+    CappedNumber &operator=(const CappedNumber &other) = default;
 
     //----------------------------------------------------------------------------------------------
 
     CappedNumber &operator=(uint16_t val)
     {
-        value = val;
-        trim();
+        value = Wrap::reduce(val);
         return *this;
     }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber &operator-=(const CappedNumber &other)
-    {
-        this->operator-=(other.value);
-        return *this;
-    }
+    CappedNumber &operator-=(const CappedNumber &other) { return operator-=(other.value); }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber &operator+=(const CappedNumber &other)
-    {
-        this->operator+=(other.value);
-        return *this;
-    }
+    CappedNumber &operator+=(const CappedNumber &other) { return operator+=(other.value); }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber &operator-=(const int16_t val)
-    {
-        if(val < 0) // increment
-            value += -val;
-        else // decrement
-        {
-            if(val > value) // on underflow
-                value = MAX - (val - value);
-            else
-                value -= val;
-        }
-        trim();
+    CappedNumber &operator-=(int32_t val)
+    {
+        value = Wrap::add(value, -val);
         return *this;
     }
 
     //----------------------------------------------------------------------------------------------
 
-    CappedNumber &operator+=(int16_t val)
+    CappedNumber &operator+=(int32_t val)
     {
-        if(val > 0) // increment
-            value += val;
-        else // decrement
-        {
-            if(val + value < 0) // on underflow
-                value = MAX + (val + value);
-            else
-                value -= -val;
-        }
-
-        trim();
+        value = Wrap::add(value, val);
         return *this;
     }
 
     //----------------------------------------------------------------------------------------------
 
-    bool operator==(const CappedNumber &other) { return operator==(other.value); }
+    constexpr bool operator==(const CappedNumber &other) const { return value == other.value; }
 
-    bool operator!=(const CappedNumber &other) { return !operator==(other.value); }
+    constexpr bool operator!=(const CappedNumber &other) const { return value != other.value; }
 
-    bool operator==(uint16_t val) { return value == val; }
+    constexpr bool operator==(uint16_t val) const { return value == val; }
 
-    bool operator!=(uint16_t val) { return !operator==(val); }
+    constexpr bool operator!=(uint16_t val) const { return value != val; }
 
-    operator uint16_t() { return value; }
+    constexpr operator uint16_t() const { return value; }
 
 private:
-    inline void trim() { value %= MAX; }
+    //! tag of values within [0, MAX) already
+    struct Reduced
+    {
+    };
+
+    constexpr CappedNumber(uint16_t val, Reduced) : value(val) {}
 
     uint16_t value{ 0 };
-};
\ No newline at end of file
+};
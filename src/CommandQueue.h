@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Bounded lock-free queue with any number of producers and a single consumer, i.e. button ISRs
+//! and a network task on one core posting commands to the render loop on another core. Producers
+//! claim a cell by advancing the tail and publish it by means of the cell's sequence number; a
+//! producer interrupted in between delays the consumer but never blocks another producer.
+//!
+//! \tparam T trivially copyable element
+//! \tparam CAPACITY number of elements, a power of two; 0 removes the queue, push() fails then
+template <typename T, uint8_t CAPACITY> class CommandQueue
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    static constexpr bool enabled = true;
+
+    CommandQueue()
+    {
+        for(uint8_t i = 0; i < CAPACITY; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    //! Appends an element, safe to call from any thread and from ISRs.
+    //! \return false if the queue is full
+    bool push(const T &value);
+
+    //! Takes the oldest element, to be called from the consumer only.
+    //! \return false if the queue is empty or the oldest element is still being written
+    bool pop(T &value);
+
+private:
+    struct Cell
+    {
+        //! position + 1 once written, position + CAPACITY once read
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    Cell cells[CAPACITY];
+    std::atomic<uint32_t> tail{ 0 };
+    //! read by the consumer only
+    uint32_t head{ 0 };
+};
+
+template <typename T> class CommandQueue<T, 0>
+{
+public:
+    static constexpr bool enabled = false;
+
+    bool push(const T &) { return false; }
+
+    bool pop(T &) { return false; }
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename T, uint8_t CAPACITY> bool CommandQueue<T, CAPACITY>::push(const T &value)
+{
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        Cell &cell = cells[position & (CAPACITY - 1)];
+        const uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const int32_t lag = static_cast<int32_t>(sequence - position);
+
+        if(lag < 0) // not read yet since the last round, full
+            return false;
+
+        if(lag > 0) // claimed by another producer meanwhile
+        {
+            position = tail.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if(tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+            cell.value = value;
+            cell.sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename T, uint8_t CAPACITY> bool CommandQueue<T, CAPACITY>::pop(T &value)
+{
+    Cell &cell = cells[head & (CAPACITY - 1)];
+    if(cell.sequence.load(std::memory_order_acquire) != head + 1)
+        return false;
+
+    value = cell.value;
+    cell.sequence.store(head + CAPACITY, std::memory_order_release);
+    ++head;
+    return true;
+}
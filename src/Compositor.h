@@ -0,0 +1,581 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "BrightnessScale.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! How an overlay color is combined with the color below it.
+enum class BlendMode : uint8_t
+{
+    //! overlay color replaces the color below
+    Normal,
+    //! channel wise sum, saturating at 255
+    Add,
+    //! channel wise product, darkens
+    Multiply,
+    //! inverse product of the inverses, lightens
+    Screen,
+    //! channel wise maximum
+    Lighten,
+    //! channel wise minimum
+    Darken
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Blend modes on packed 0xWWRRGGBB colors.
+struct PixelBlend
+{
+    static uint32_t apply(BlendMode mode, uint32_t below, uint32_t above)
+    {
+        switch(mode)
+        {
+        case BlendMode::Normal:
+            return above;
+        case BlendMode::Add:
+            return add(below, above);
+        case BlendMode::Multiply:
+            return multiply(below, above);
+        case BlendMode::Screen:
+            return ~multiply(~below, ~above);
+        case BlendMode::Lighten:
+            return perChannel(below, above, [](uint8_t a, uint8_t b) { return (a > b) ? a : b; });
+        case BlendMode::Darken:
+            return perChannel(below, above, [](uint8_t a, uint8_t b) { return (a < b) ? a : b; });
+        }
+        return above;
+    }
+
+    //! Saturating sum of all four channels at once.
+    static uint32_t add(uint32_t a, uint32_t b)
+    {
+        // sum of the lower 7 bits of each channel, which cannot carry into the next channel
+        const uint32_t low = (a & 0x7f7f7f7f) + (b & 0x7f7f7f7f);
+        const uint32_t sum = low ^ ((a ^ b) & 0x80808080);
+        // carry out of bit 7 of each channel
+        const uint32_t carry = ((a & b) | ((a | b) & low)) & 0x80808080;
+        return sum | ((carry >> 7) * 0xff);
+    }
+
+    static uint32_t multiply(uint32_t a, uint32_t b)
+    {
+        return perChannel(a, b, [](uint8_t x, uint8_t y) {
+            return static_cast<uint8_t>((x * (y + 1)) >> 8);
+        });
+    }
+
+    template <typename F> static uint32_t perChannel(uint32_t a, uint32_t b, F f)
+    {
+        uint32_t result = 0;
+        for(uint8_t shift = 0; shift < 32; shift += 8)
+            result |= static_cast<uint32_t>(f(static_cast<uint8_t>(a >> shift),
+                                              static_cast<uint8_t>(b >> shift)))
+                      << shift;
+        return result;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Layer stack composited over a scene in one pass over the strip. The scene provides a color per
+//! pixel (a shader), above it arcs and masks restrict what is visible and overlays blend a color
+//! into a pixel range. The scene is visible within any of the arcs, if there are arcs at all, and
+//! within all of the masks. Pixel ranges start at any pixel and wrap around the end of the strip.
+//!
+//! The strip is split into segments at the borders of all layers and each segment is written as a
+//! whole: pixels not visible are cleared without evaluating the scene or any overlay, overlays not
+//! visible at all are not evaluated either. The brightness scale is applied in the same pass.
+//!
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS = 4> class Compositor
+{
+public:
+    //! returned by addMask() and addOverlay() if no layer is left
+    static constexpr uint8_t none = 0xff;
+
+    //! Adds an arc: the scene and overlays are visible within the range and within further arcs.
+    //! \return layer id, none if all layers are taken
+    uint8_t addArc(uint16_t begin, uint16_t length)
+    {
+        return add(Layer::Arc, begin, length, 0, BlendMode::Normal);
+    }
+
+    //! Adds a mask: the scene and overlays are visible within the range only.
+    //! \return layer id, none if all layers are taken
+    uint8_t addMask(uint16_t begin, uint16_t length)
+    {
+        return add(Layer::Mask, begin, length, 0, BlendMode::Normal);
+    }
+
+    //! Adds an overlay: blends color into the range.
+    //! \return layer id, none if all layers are taken
+    uint8_t addOverlay(uint16_t begin,
+                       uint16_t length,
+                       uint32_t color,
+                       BlendMode mode = BlendMode::Normal)
+    {
+        return add(Layer::Overlay, begin, length, color, mode);
+    }
+
+    void remove(uint8_t id);
+
+    //! \param length number of pixels, LED_COUNT at most
+    void setRange(uint8_t id, uint16_t begin, uint16_t length);
+
+    void setColor(uint8_t id, uint32_t color);
+
+    void setMode(uint8_t id, BlendMode mode);
+
+    void setEnabled(uint8_t id, bool enabled);
+
+    //! Sets the brightness scale 0-256 the composited colors are scaled by.
+    void setScale(uint16_t new_scale);
+
+    //! \return a number which changes whenever the composition changes, i.e. to tell whether a
+    //! static scene needs to be composited again
+    uint16_t revision() const { return current_revision; }
+
+    //! Composites all layers over the scene and writes the result into the strip.
+    //! \param shader provides the scene color of a pixel: uint32_t shader(uint16_t pixel)
+    template <typename Strip, typename Shader>
+    void compose(Strip &strip, const Shader &shader) const;
+
+    //! Composites all layers over the scene and writes the result straight into the strip buffer,
+    //! without a call to Strip::setPixelColor() per pixel.
+    //! \tparam Span pixel layout of the buffer, see PixelSpan
+    //! \param pixels strip buffer, i.e. Strip::getPixels()
+    //! \param shader provides the scene color of a pixel: uint32_t shader(uint16_t pixel)
+    template <typename Span, typename Shader>
+    void composePixels(uint8_t *pixels, const Shader &shader) const;
+
+    //! Composites all layers over a scene of a single color and writes the result straight into the
+    //! strip buffer, one fill per segment.
+    //! \tparam Span pixel layout of the buffer, see PixelSpan
+    //! \param pixels strip buffer, i.e. Strip::getPixels()
+    template <typename Span> void composeColor(uint8_t *pixels, uint32_t color) const;
+
+    //! Composites all layers over a palette indexed scene and writes the result straight into the
+    //! strip buffer. The palette is blended, scaled and encoded into a table on the stack
+    //! (PALETTE_SIZE * bytes per pixel) once per set of overlays, each pixel is then a copy of its
+    //! table entry.
+    //! \tparam Span pixel layout of the buffer, see PixelSpan
+    //! \param pixels strip buffer, i.e. Strip::getPixels()
+    //! \param indices palette entry per pixel, below PALETTE_SIZE
+    //! \param palette provides the color of a palette entry: uint32_t palette(uint8_t entry)
+    template <typename Span, uint16_t PALETTE_SIZE, typename Palette>
+    void composeIndexed(uint8_t *pixels, const uint8_t *indices, const Palette &palette) const;
+
+private:
+    //! pixel range as up to two spans [begin, end)
+    struct Range
+    {
+        bool contains(uint16_t pixel) const
+        {
+            return (pixel >= begin[0] && pixel < end[0]) || (pixel >= begin[1] && pixel < end[1]);
+        }
+
+        bool intersects(const Range &other) const
+        {
+            for(uint8_t i = 0; i < 2; i++)
+                for(uint8_t j = 0; j < 2; j++)
+                    if(begin[i] < other.end[j] && other.begin[j] < end[i])
+                        return true;
+            return false;
+        }
+
+        bool empty() const { return begin[0] == end[0] && begin[1] == end[1]; }
+
+        uint16_t begin[2];
+        uint16_t end[2];
+    };
+
+    struct Layer
+    {
+        enum Kind : uint8_t
+        {
+            Unused,
+            Arc,
+            Mask,
+            Overlay
+        };
+
+        Range range;
+        uint32_t color;
+        Kind kind;
+        BlendMode mode;
+        bool enabled;
+    };
+
+    uint8_t add(typename Layer::Kind kind,
+                uint16_t begin,
+                uint16_t length,
+                uint32_t color,
+                BlendMode mode);
+
+    //! Splits the strip into segments within which the same layers apply to each pixel.
+    //! \param segment called for each segment:
+    //!     void segment(uint16_t begin, uint16_t end, bool visible, const Layer *const *overlays,
+    //!                  uint8_t overlay_count)
+    //! \return false if nothing is visible at all, no segment is reported then
+    template <typename Segment> bool segments(const Segment &segment) const;
+
+    //! Composites pixel by pixel.
+    //! \param set_pixel writes a pixel: void set_pixel(uint16_t pixel, uint32_t color)
+    //! \param clear turns pixels off: void clear(uint16_t begin, uint16_t count)
+    template <typename Shader, typename SetPixel, typename Clear>
+    void composeWith(const Shader &shader, const SetPixel &set_pixel, const Clear &clear) const;
+
+    Layer layers[MAX_LAYERS] = {};
+    uint16_t scale{ BrightnessScale::max_scale };
+    uint16_t current_revision{ 0 };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+uint8_t Compositor<LED_COUNT, MAX_LAYERS>::add(typename Layer::Kind kind,
+                                               uint16_t begin,
+                                               uint16_t length,
+                                               uint32_t color,
+                                               BlendMode mode)
+{
+    for(uint8_t id = 0; id < MAX_LAYERS; id++)
+    {
+        if(layers[id].kind != Layer::Unused)
+            continue;
+
+        layers[id].kind = kind;
+        layers[id].color = color;
+        layers[id].mode = mode;
+        layers[id].enabled = true;
+        setRange(id, begin, length);
+        return id;
+    }
+    return none;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+void Compositor<LED_COUNT, MAX_LAYERS>::remove(uint8_t id)
+{
+    if(id >= MAX_LAYERS)
+        return;
+
+    layers[id].kind = Layer::Unused;
+    ++current_revision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+void Compositor<LED_COUNT, MAX_LAYERS>::setRange(uint8_t id, uint16_t begin, uint16_t length)
+{
+    if(id >= MAX_LAYERS)
+        return;
+
+    begin %= LED_COUNT;
+    length = (length > LED_COUNT) ? LED_COUNT : length;
+
+    Range &range = layers[id].range;
+    const uint16_t end = begin + length;
+    range.begin[0] = begin;
+    range.end[0] = (end > LED_COUNT) ? LED_COUNT : end;
+    // the part wrapped around
+    range.begin[1] = 0;
+    range.end[1] = (end > LED_COUNT) ? end - LED_COUNT : 0;
+    ++current_revision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+void Compositor<LED_COUNT, MAX_LAYERS>::setColor(uint8_t id, uint32_t color)
+{
+    if(id >= MAX_LAYERS || layers[id].color == color)
+        return;
+
+    layers[id].color = color;
+    ++current_revision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+void Compositor<LED_COUNT, MAX_LAYERS>::setMode(uint8_t id, BlendMode mode)
+{
+    if(id >= MAX_LAYERS || layers[id].mode == mode)
+        return;
+
+    layers[id].mode = mode;
+    ++current_revision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+void Compositor<LED_COUNT, MAX_LAYERS>::setEnabled(uint8_t id, bool enabled)
+{
+    if(id >= MAX_LAYERS || layers[id].enabled == enabled)
+        return;
+
+    layers[id].enabled = enabled;
+    ++current_revision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+void Compositor<LED_COUNT, MAX_LAYERS>::setScale(uint16_t new_scale)
+{
+    if(scale == new_scale)
+        return;
+
+    scale = new_scale;
+    ++current_revision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+template <typename Segment>
+bool Compositor<LED_COUNT, MAX_LAYERS>::segments(const Segment &segment) const
+{
+    // cull: collect the layers which contribute to at least one pixel
+    const Layer *arcs[MAX_LAYERS];
+    const Layer *masks[MAX_LAYERS];
+    const Layer *overlays[MAX_LAYERS];
+    uint8_t arc_count = 0, mask_count = 0, overlay_count = 0;
+    bool has_arcs = false;
+    bool visible = scale > 0;
+
+    for(const Layer &layer : layers)
+    {
+        if(!layer.enabled)
+            continue;
+
+        if(layer.kind == Layer::Arc)
+        {
+            has_arcs = true;
+            if(!layer.range.empty())
+                arcs[arc_count++] = &layer;
+        }
+        else if(layer.kind == Layer::Mask)
+        {
+            visible = visible && !layer.range.empty();
+            masks[mask_count++] = &layer;
+        }
+    }
+    visible = visible && (!has_arcs || arc_count > 0);
+
+    auto hidden = [&](const Range &range) -> bool {
+        bool within_arc = !has_arcs;
+        for(uint8_t a = 0; a < arc_count && !within_arc; a++)
+            within_arc = arcs[a]->range.intersects(range);
+
+        bool masked_out = !within_arc;
+        for(uint8_t m = 0; m < mask_count && !masked_out; m++)
+            masked_out = !masks[m]->range.intersects(range);
+        return masked_out;
+    };
+
+    for(const Layer &layer : layers)
+    {
+        if(layer.kind == Layer::Overlay && layer.enabled && !layer.range.empty() &&
+           !hidden(layer.range))
+            overlays[overlay_count++] = &layer;
+    }
+
+    if(!visible)
+        return false;
+
+    // the strip is split into segments at the borders of all layers
+    uint16_t borders[2 + 4 * MAX_LAYERS] = { 0, LED_COUNT };
+    uint8_t border_count = 2;
+    auto addBorders = [&](const Layer *layer) {
+        for(uint8_t i = 0; i < 2; i++)
+        {
+            borders[border_count++] = layer->range.begin[i];
+            borders[border_count++] = layer->range.end[i];
+        }
+    };
+    for(uint8_t a = 0; a < arc_count; a++)
+        addBorders(arcs[a]);
+    for(uint8_t m = 0; m < mask_count; m++)
+        addBorders(masks[m]);
+    for(uint8_t o = 0; o < overlay_count; o++)
+        addBorders(overlays[o]);
+
+    // insertion sort, there are a few borders only
+    for(uint8_t i = 1; i < border_count; i++)
+        for(uint8_t j = i; j > 0 && borders[j - 1] > borders[j]; j--)
+        {
+            const uint16_t border = borders[j];
+            borders[j] = borders[j - 1];
+            borders[j - 1] = border;
+        }
+
+    for(uint8_t i = 0; i + 1 < border_count; i++)
+    {
+        const uint16_t begin = borders[i], end = borders[i + 1];
+        if(begin >= end)
+            continue;
+
+        // the segment is a range of its own, a pixel of it tells which layers apply
+        const Range pixel = { { begin, 0 }, { static_cast<uint16_t>(begin + 1), 0 } };
+        if(hidden(pixel))
+        {
+            segment(begin, end, false, overlays, 0);
+            continue;
+        }
+
+        const Layer *active[MAX_LAYERS];
+        uint8_t active_count = 0;
+        for(uint8_t o = 0; o < overlay_count; o++)
+        {
+            if(overlays[o]->range.contains(begin))
+                active[active_count++] = overlays[o];
+        }
+        segment(begin, end, true, active, active_count);
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+template <typename Shader, typename SetPixel, typename Clear>
+void Compositor<LED_COUNT, MAX_LAYERS>::composeWith(const Shader &shader,
+                                                    const SetPixel &set_pixel,
+                                                    const Clear &clear) const
+{
+    const bool visible = segments([&](uint16_t begin, uint16_t end, bool segment_visible,
+                                      const Layer *const *active, uint8_t active_count) {
+        if(!segment_visible)
+        {
+            clear(begin, end - begin);
+            return;
+        }
+
+        if(active_count == 0 && scale >= BrightnessScale::max_scale)
+        {
+            // plain scene, i.e. within the arc at full brightness
+            for(uint16_t pixel = begin; pixel < end; pixel++)
+                set_pixel(pixel, shader(pixel));
+            return;
+        }
+
+        for(uint16_t pixel = begin; pixel < end; pixel++)
+        {
+            uint32_t color = shader(pixel);
+            for(uint8_t o = 0; o < active_count; o++)
+                color = PixelBlend::apply(active[o]->mode, color, active[o]->color);
+            set_pixel(pixel, BrightnessScale::apply(color, scale));
+        }
+    });
+
+    if(!visible)
+        clear(0, LED_COUNT);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+template <typename Strip, typename Shader>
+void Compositor<LED_COUNT, MAX_LAYERS>::compose(Strip &strip, const Shader &shader) const
+{
+    composeWith(
+    shader, [&strip](uint16_t pixel, uint32_t color) { strip.setPixelColor(pixel, color); },
+    [&strip](uint16_t begin, uint16_t count) { strip.fill(0, begin, count); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+template <typename Span, typename Shader>
+void Compositor<LED_COUNT, MAX_LAYERS>::composePixels(uint8_t *pixels, const Shader &shader) const
+{
+    composeWith(
+    shader,
+    [pixels](uint16_t pixel, uint32_t color) {
+        Span::encode(color, &pixels[pixel * Span::bytes_per_pixel]);
+    },
+    [pixels](uint16_t begin, uint16_t count) { Span::clear(pixels, begin, count); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+template <typename Span>
+void Compositor<LED_COUNT, MAX_LAYERS>::composeColor(uint8_t *pixels, uint32_t color) const
+{
+    const bool visible = segments([&](uint16_t begin, uint16_t end, bool segment_visible,
+                                      const Layer *const *active, uint8_t active_count) {
+        if(!segment_visible)
+        {
+            Span::clear(pixels, begin, end - begin);
+            return;
+        }
+
+        // the same color for each pixel of the segment
+        uint32_t segment_color = color;
+        for(uint8_t o = 0; o < active_count; o++)
+            segment_color = PixelBlend::apply(active[o]->mode, segment_color, active[o]->color);
+        Span::fill(pixels, BrightnessScale::apply(segment_color, scale), begin, end - begin);
+    });
+
+    if(!visible)
+        Span::clear(pixels, 0, LED_COUNT);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LED_COUNT, uint8_t MAX_LAYERS>
+template <typename Span, uint16_t PALETTE_SIZE, typename Palette>
+void Compositor<LED_COUNT, MAX_LAYERS>::composeIndexed(uint8_t *pixels,
+                                                       const uint8_t *indices,
+                                                       const Palette &palette) const
+{
+    const uint8_t bpp = Span::bytes_per_pixel;
+    uint8_t table[PALETTE_SIZE * Span::bytes_per_pixel];
+    // overlays the table was made for, none yet
+    const Layer *tabled[MAX_LAYERS] = {};
+    uint8_t tabled_count = MAX_LAYERS + 1;
+
+    const bool visible = segments([&](uint16_t begin, uint16_t end, bool segment_visible,
+                                      const Layer *const *active, uint8_t active_count) {
+        if(!segment_visible)
+        {
+            Span::clear(pixels, begin, end - begin);
+            return;
+        }
+
+        bool same = tabled_count == active_count;
+        for(uint8_t o = 0; o < active_count && same; o++)
+            same = tabled[o] == active[o];
+        if(!same)
+        {
+            for(uint16_t entry = 0; entry < PALETTE_SIZE; entry++)
+            {
+                uint32_t color = palette(static_cast<uint8_t>(entry));
+                for(uint8_t o = 0; o < active_count; o++)
+                    color = PixelBlend::apply(active[o]->mode, color, active[o]->color);
+                Span::encode(BrightnessScale::apply(color, scale), &table[entry * bpp]);
+            }
+            for(uint8_t o = 0; o < active_count; o++)
+                tabled[o] = active[o];
+            tabled_count = active_count;
+        }
+
+        // local pointers, the bytes written could alias the closure's references otherwise
+        const uint8_t *const entries = table;
+        uint8_t *out = &pixels[begin * bpp];
+        const uint8_t *const in_end = &indices[end];
+        for(const uint8_t *in = &indices[begin]; in != in_end; in++, out += bpp)
+            memcpy(out, &entries[*in * bpp], bpp);
+    });
+
+    if(!visible)
+        Span::clear(pixels, 0, LED_COUNT);
+}
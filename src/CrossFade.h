@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "BrightnessScale.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Fixed point linear interpolation of pixel buffers, SWAR-wise like BrightnessScale.
+struct CrossFade
+{
+    static constexpr uint16_t max_weight = 256;
+
+    //! \return weight 0-256 of the given progress
+    static uint16_t weight(uint32_t elapsed_ms, uint32_t duration_ms)
+    {
+        return (elapsed_ms >= duration_ms || duration_ms == 0) ?
+               max_weight :
+               static_cast<uint16_t>((elapsed_ms * max_weight) / duration_ms);
+    }
+
+    //! Blends two packed colors.
+    //! \param weight 0 yields from, 256 yields to
+    static uint32_t blend(uint32_t from, uint32_t to, uint16_t weight)
+    {
+        // each channel is at most 255 since from * (256 - w) + to * w <= 255 * 256
+        return BrightnessScale::apply(from, max_weight - weight) +
+               BrightnessScale::apply(to, weight);
+    }
+
+    //! Blends two buffers into the output buffer in one pass; out may alias from or to.
+    //! \param weight 0 yields from, 256 yields to
+    static void
+    blend(uint8_t *out, const uint8_t *from, const uint8_t *to, uint16_t size, uint16_t weight)
+    {
+        if(weight >= max_weight)
+        {
+            if(out != to)
+                memmove(out, to, size);
+            return;
+        }
+
+        uint16_t i = 0;
+        for(; i + 4 <= size; i += 4)
+        {
+            uint32_t a, b;
+            memcpy(&a, &from[i], 4);
+            memcpy(&b, &to[i], 4);
+            a = blend(a, b, weight);
+            memcpy(&out[i], &a, 4);
+        }
+
+        for(; i < size; i++)
+            out[i] = static_cast<uint8_t>((from[i] * (max_weight - weight) + to[i] * weight) >> 8);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Buffers of a transition: the outgoing and the incoming scene render into a buffer of their own,
+//! both are blended into the strip buffer. A SIZE of 0 disables transitions and spares the RAM.
+template <uint16_t SIZE> struct CrossFadeBuffers
+{
+    static constexpr bool enabled = true;
+
+    uint8_t from[SIZE];
+    uint8_t to[SIZE];
+};
+
+template <> struct CrossFadeBuffers<0>
+{
+    static constexpr bool enabled = false;
+
+    uint8_t from[1];
+    uint8_t to[1];
+};
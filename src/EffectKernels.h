@@ -0,0 +1,194 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! 8 bit fixed point arithmetic: values 0-255 represent 0-1, no divisions.
+struct Fixed8
+{
+    //! \return x * scale / 256, x for a scale of 255
+    static uint8_t scale(uint8_t x, uint8_t scale)
+    {
+        return static_cast<uint8_t>((x * (scale + 1U)) >> 8);
+    }
+
+    //! \return x + y saturated at 255
+    static uint8_t addSaturated(uint8_t x, uint8_t y)
+    {
+        const uint16_t sum = static_cast<uint16_t>(x + y);
+        return (sum > 255) ? 255 : static_cast<uint8_t>(sum);
+    }
+
+    //! \return x - y saturated at 0
+    static uint8_t subSaturated(uint8_t x, uint8_t y) { return (x > y) ? x - y : 0; }
+
+    //! \return smooth (3t^2 - 2t^3) interpolation weight of t
+    static uint8_t smoothstep(uint8_t t)
+    {
+        return static_cast<uint8_t>((static_cast<uint32_t>(t * t) * (768U - 2U * t)) >> 16);
+    }
+
+    //! \return a + (b - a) * t / 256
+    static uint8_t lerp(uint8_t a, uint8_t b, uint8_t t)
+    {
+        return static_cast<uint8_t>((a * (256U - t) + b * static_cast<uint16_t>(t)) >> 8);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Xorshift pseudo random number generator (Marsaglia): three shifts and xors per number, a
+//! period of 2^32 - 1, trivially copyable so it fits into a scene state.
+struct Xorshift32
+{
+    //! \param value any seed, 0 is replaced since it is a fixed point
+    void seed(uint32_t value) { state = (value == 0) ? 2463534242UL : value; }
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    uint8_t next8() { return static_cast<uint8_t>(next() >> 24); }
+
+    //! \return uniformly distributed 0-(n-1) by a multiplication rather than a modulo
+    uint8_t below(uint8_t n) { return static_cast<uint8_t>((next8() * n) >> 8); }
+
+    uint32_t state{ 2463534242UL };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Heat diffusion fire along a strip (after Fire2012 by Mark Kriegsman): each step cools every
+//! cell a little, drifts the heat away from pixel 0 and randomly ignites sparks near pixel 0.
+struct FireKernel
+{
+    //! \param cooling how much the cells cool per step, 20-100 is reasonable
+    //! \param sparking chance of a new spark per step of 255
+    template <uint16_t LED_COUNT>
+    static void step(uint8_t (&heat)[LED_COUNT], Xorshift32 &random, uint8_t cooling,
+                     uint8_t sparking)
+    {
+        // once per step: cooling relative to the length of the strip, saturated for short strips
+        const uint32_t cooling_range = cooling * 10U / LED_COUNT + 2;
+        const uint8_t max_cooling =
+        (cooling_range > 255) ? 255 : static_cast<uint8_t>(cooling_range);
+        for(uint16_t i = 0; i < LED_COUNT; i++)
+            heat[i] = Fixed8::subSaturated(heat[i], random.below(max_cooling));
+
+        // each cell takes (one + two times the next) of the two cells below, 85 / 256 ~ 1 / 3
+        for(uint16_t i = LED_COUNT - 1; i >= 2; i--)
+            heat[i] = static_cast<uint8_t>(((heat[i - 1] + 2U * heat[i - 2]) * 85U) >> 8);
+
+        if(random.next8() < sparking)
+        {
+            const uint8_t y = random.below((LED_COUNT < 7) ? static_cast<uint8_t>(LED_COUNT) : 7);
+            heat[y] = Fixed8::addSaturated(heat[y], static_cast<uint8_t>(160 + random.below(96)));
+        }
+    }
+
+    //! \return black body color of the heat: black, red, yellow, white
+    static uint32_t color(uint8_t heat)
+    {
+        // 0-191 in three ramps of 64
+        const uint8_t t = Fixed8::scale(heat, 191);
+        const uint8_t ramp = static_cast<uint8_t>((t & 0x3f) << 2);
+        if(t & 0x80)
+            return 0xffff00UL | ramp;
+        if(t & 0x40)
+            return 0xff0000UL | (static_cast<uint32_t>(ramp) << 8);
+        return static_cast<uint32_t>(ramp) << 16;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Comet running around the ring with a decaying tail. Intensities 0-255 per pixel, the head is a
+//! 8.8 fixed point position so that it moves at any speed regardless of the frame rate.
+struct CometKernel
+{
+    //! Fades all pixels and lights the ones the head passed.
+    //! \param head position of the head in 1/256 pixels, within [0, LED_COUNT * 256)
+    //! \param advance distance the head moves in 1/256 pixels
+    //! \param fade scale of the intensity per step, the tail gets longer towards 255
+    template <uint16_t LED_COUNT>
+    static void step(uint8_t (&intensity)[LED_COUNT], uint32_t &head, uint32_t advance,
+                     uint8_t fade)
+    {
+        for(uint16_t i = 0; i < LED_COUNT; i++)
+            intensity[i] = Fixed8::scale(intensity[i], fade);
+
+        const uint32_t length = static_cast<uint32_t>(LED_COUNT) << 8;
+        // at most one round per step
+        uint32_t pixels = (advance >> 8) + 1;
+        pixels = (pixels > LED_COUNT) ? LED_COUNT : pixels;
+        uint16_t pixel = static_cast<uint16_t>(head >> 8);
+        for(; pixels > 0; pixels--)
+        {
+            intensity[pixel] = 255;
+            pixel = (pixel + 1 == LED_COUNT) ? 0 : static_cast<uint16_t>(pixel + 1);
+        }
+
+        head += (advance < length) ? advance : advance % length;
+        head = (head >= length) ? head - length : head;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Pixels lighting up at random and fading out, each of a random hue.
+struct TwinkleKernel
+{
+    //! \param density chance of a pixel lighting up per step of 256
+    //! \param fade scale of the level per step
+    template <uint16_t LED_COUNT>
+    static void step(uint8_t (&level)[LED_COUNT], uint8_t (&hue)[LED_COUNT], Xorshift32 &random,
+                     uint8_t density, uint8_t fade)
+    {
+        for(uint16_t i = 0; i < LED_COUNT; i++)
+        {
+            level[i] = Fixed8::scale(level[i], fade);
+            if(random.next8() < density)
+            {
+                level[i] = 255;
+                hue[i] = random.next8();
+            }
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! One dimensional value noise: random values on a lattice, smoothly interpolated in between. The
+//! lattice values are hashed from their position, so no table is needed.
+struct NoiseKernel
+{
+    //! \return random value of lattice point
+    static uint8_t lattice(uint8_t point)
+    {
+        // multiplicative hash (golden ratio), the top bits are the best mixed
+        return static_cast<uint8_t>(static_cast<uint32_t>(point * 2654435761UL) >> 24);
+    }
+
+    //! \param x position in 1/256 lattice cells, the noise repeats each 256 cells
+    //! \return 0-255
+    static uint8_t value(uint16_t x)
+    {
+        const uint8_t point = static_cast<uint8_t>(x >> 8);
+        return Fixed8::lerp(lattice(point), lattice(static_cast<uint8_t>(point + 1)),
+                            Fixed8::smoothstep(static_cast<uint8_t>(x)));
+    }
+
+    //! \return two octaves of value(), the second of twice the frequency and half the amplitude
+    static uint8_t fractal(uint16_t x)
+    {
+        // (2 * first + second) * 85 / 256 ~ (2 * first + second) / 3
+        const uint16_t sum = value(x) * 2U + value(static_cast<uint16_t>(x * 2U + 0x5a5a));
+        return static_cast<uint8_t>((sum * 85U) >> 8);
+    }
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <stdint.h>
+#include "BrightnessScale.h"
+#include "EffectKernels.h"
+#include "HueTable.h"
+#include "SceneRegistry.h"
+#include "Scenes.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Frame logic shared by the effect scenes: the kernel is stepped each STEP_MS, the pixels are
+//! composed whenever it stepped or the composition changed (i.e. the arc or the brightness).
+template <uint16_t STEP_MS> struct EffectFrame
+{
+    //! steps a kernel without a speed of its own catches up at most per frame, see catchUp()
+    static constexpr uint8_t max_catch_up = 8;
+
+    //! \return number of kernel steps to run for the steps elapsed, so that kernels which advance
+    //! by one step per call stay on time at low frame rates without stalling a frame after a stall
+    static uint8_t catchUp(uint32_t steps)
+    {
+        return (steps > max_catch_up) ? max_catch_up : static_cast<uint8_t>(steps);
+    }
+
+    //! \param step steps the kernel: void step(uint32_t steps, bool first), steps since the last
+    //! step (1 at least), first on the very first step of the scene
+    //! \param shader provides the color of a pixel as of PixelRing::compose()
+    template <typename Ring, typename Step, typename Shader>
+    static void render(Ring &ring, ScenePhase &phase, uint16_t dt_ms, const Step &step,
+                       const Shader &shader)
+    {
+        const uint16_t revision = ring.getLayers().revision();
+        if(!phase.due(STEP_MS, revision))
+        {
+            phase.advance(STEP_MS, dt_ms, revision);
+            ring.skipFrame();
+            return;
+        }
+
+        if(phase.due(STEP_MS))
+        {
+            const bool first = !phase.rendered;
+            step(first ? 1 : phase.step(STEP_MS) - phase.rendered_step, first);
+        }
+        phase.advance(STEP_MS, dt_ms, revision);
+
+        ring.compose(shader);
+        ring.emitFrame();
+    }
+
+    //! \return a seed which differs between rings, so that rings do not show the same effect
+    template <typename Ring> static uint32_t seed()
+    {
+        return static_cast<uint32_t>(0x9e3779b9UL * (Ring::led_pin + 1U)) ^ Ring::led_count;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Fire rising from pixel 0, see FireKernel. Keeps a heat per pixel.
+//! \tparam COOLING how much the fire cools per step, 20-100
+//! \tparam SPARKING chance of a new spark per step of 255
+template <uint8_t COOLING = 55, uint8_t SPARKING = 120, uint16_t STEP_MS = 15> struct FireScene
+{
+    template <uint16_t LED_COUNT> struct PixelState
+    {
+        ScenePhase phase;
+        Xorshift32 random;
+        uint8_t heat[LED_COUNT];
+    };
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring>
+    static void render(Ring &ring, PixelState<Ring::led_count> &state, uint16_t dt_ms)
+    {
+        EffectFrame<STEP_MS>::render(
+        ring, state.phase, dt_ms,
+        [&state](uint32_t steps, bool first) {
+            if(first)
+                state.random.seed(EffectFrame<STEP_MS>::template seed<Ring>());
+            for(uint8_t i = EffectFrame<STEP_MS>::catchUp(steps); i > 0; i--)
+                FireKernel::step(state.heat, state.random, COOLING, SPARKING);
+        },
+        [&state](uint16_t pixel) { return FireKernel::color(state.heat[pixel]); });
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Comet in the given color running around the ring, see CometKernel. Keeps an intensity per
+//! pixel.
+//! \tparam PIXELS_PER_S speed of the head
+//! \tparam FADE scale of the tail per step, the tail gets longer towards 255
+template <uint8_t R,
+          uint8_t G,
+          uint8_t B,
+          uint16_t PIXELS_PER_S = 60,
+          uint8_t FADE = 200,
+          uint16_t STEP_MS = 10>
+struct CometScene
+{
+    template <uint16_t LED_COUNT> struct PixelState
+    {
+        ScenePhase phase;
+        //! position of the head in 1/256 pixels
+        uint32_t head;
+        uint8_t intensity[LED_COUNT];
+    };
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring>
+    static void render(Ring &ring, PixelState<Ring::led_count> &state, uint16_t dt_ms)
+    {
+        // distance per step in 1/256 pixels
+        const uint32_t advance = STEP_MS * PIXELS_PER_S * 256UL / 1000;
+        const uint32_t color = Ring::Strip::Color(R, G, B);
+
+        EffectFrame<STEP_MS>::render(
+        ring, state.phase, dt_ms,
+        [&state, advance](uint32_t steps, bool) {
+            CometKernel::step(state.intensity, state.head, steps * advance, FADE);
+        },
+        [&state, color](uint16_t pixel) {
+            return BrightnessScale::apply(color, state.intensity[pixel] + 1U);
+        });
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Pixels lighting up in random colors and fading out, see TwinkleKernel. Keeps a level and a hue
+//! per pixel.
+//! \tparam DENSITY chance of a pixel lighting up per step of 256
+//! \tparam FADE scale of the level per step
+template <uint8_t DENSITY = 4, uint8_t FADE = 235, uint16_t STEP_MS = 20> struct TwinkleScene
+{
+    template <uint16_t LED_COUNT> struct PixelState
+    {
+        ScenePhase phase;
+        Xorshift32 random;
+        uint8_t level[LED_COUNT];
+        uint8_t hue[LED_COUNT];
+    };
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring>
+    static void render(Ring &ring, PixelState<Ring::led_count> &state, uint16_t dt_ms)
+    {
+        EffectFrame<STEP_MS>::render(
+        ring, state.phase, dt_ms,
+        [&state](uint32_t steps, bool first) {
+            if(first)
+                state.random.seed(EffectFrame<STEP_MS>::template seed<Ring>());
+            for(uint8_t i = EffectFrame<STEP_MS>::catchUp(steps); i > 0; i--)
+                TwinkleKernel::step(state.level, state.hue, state.random, DENSITY, FADE);
+        },
+        [&state](uint16_t pixel) -> uint32_t {
+            if(state.level[pixel] == 0)
+                return 0;
+            const uint16_t hue = static_cast<uint16_t>(state.hue[pixel] << 8);
+            return BrightnessScale::apply(HueGammaTable::color(hue), state.level[pixel] + 1U);
+        });
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Colors drifting along the strip, the hue is given by value noise, see NoiseKernel.
+//! \tparam SCALE noise per pixel in 1/256 lattice cells, smaller values give larger blobs
+//! \tparam SPEED drift of the noise per step in 1/256 lattice cells
+template <uint16_t SCALE = 24, uint16_t SPEED = 16, uint16_t STEP_MS = 20> struct NoiseScene
+{
+    struct State
+    {
+        ScenePhase phase;
+        //! position of pixel 0 in 1/256 lattice cells
+        uint16_t offset{ 0 };
+    };
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t dt_ms)
+    {
+        EffectFrame<STEP_MS>::render(
+        ring, state.phase, dt_ms,
+        [&state](uint32_t steps, bool) {
+            state.offset = static_cast<uint16_t>(state.offset + steps * SPEED);
+        },
+        [&state](uint16_t pixel) {
+            const uint16_t x = static_cast<uint16_t>(pixel * SCALE + state.offset);
+            // the hue drifts on its own as well, by SPEED / 4096 revolutions per step (a full
+            // revolution each 256 steps at the default SPEED)
+            const uint16_t hue = static_cast<uint16_t>(NoiseKernel::fractal(x) << 8);
+            return HueGammaTable::color(static_cast<uint16_t>(hue + state.offset * 16U));
+        });
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+using FireSceneDefault = FireScene<>;
+using CometWhiteScene = CometScene<255, 255, 255>;
+using TwinkleSceneDefault = TwinkleScene<>;
+using NoiseSceneDefault = NoiseScene<>;
+
+//! The effect scenes, i.e. as scene list of PixelRing: PixelRing<60, D1, ..., EffectScenes>.
+//! Note that the fire, comet and twinkle keep a state per pixel: LED_COUNT bytes (twinkle:
+//! 2 * LED_COUNT), twice with PIXELRING_TRANSITIONS since the scene left last keeps its state for
+//! a transition.
+using EffectScenes =
+SceneList<FireSceneDefault, CometWhiteScene, TwinkleSceneDefault, NoiseSceneDefault, OffScene>;
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+
+//--------------------------------------------------------------------------------------------------
+
+enum class LogLevel : uint8_t
+{
+    Error = 1,
+    Warning,
+    Info,
+    Debug
+};
+
+//! Messages of the library. Only their id and value are recorded, the text is formatted when the
+//! log is flushed.
+enum class LogMessage : uint8_t
+{
+    Setup,
+    Brightness,
+    On,
+    Off,
+    Width
+};
+
+struct LogMessages
+{
+    static constexpr LogLevel level(LogMessage message)
+    {
+        return (message == LogMessage::Width) ? LogLevel::Debug : LogLevel::Info;
+    }
+
+    static constexpr bool hasValue(LogMessage message)
+    {
+        return message == LogMessage::Brightness || message == LogMessage::Width;
+    }
+
+    static const char *text(LogMessage message)
+    {
+        switch(message)
+        {
+        case LogMessage::Setup:
+            return "PixelRing::setup";
+        case LogMessage::Brightness:
+            return "PixelRing::incrementBrightness: ";
+        case LogMessage::On:
+            return "PixelRing::on: turning on";
+        case LogMessage::Off:
+            return "PixelRing::off: turning off";
+        case LogMessage::Width:
+            return "PixelRing::incrementWidth: ";
+        }
+        return "";
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Deferred log: messages are recorded as short binary entries into a ring buffer and formatted
+//! later on, when the caller has time to spare, rather than blocking on a slow UART in the midst
+//! of handling input. Messages above the log level are compiled out. Entries not fitting into the
+//! buffer are dropped and counted.
+//!
+//! \tparam CAPACITY number of entries buffered, a power of two
+//! \tparam LEVEL messages up to this LogLevel are recorded; 0 removes the log along with its RAM
+template <uint8_t CAPACITY, uint8_t LEVEL> class EventLog
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "CAPACITY must be a power of two");
+
+public:
+    static constexpr bool enabled = true;
+
+    template <LogMessage MESSAGE> void record(uint32_t time_ms, int16_t value = 0)
+    {
+        record(std::integral_constant<bool, static_cast<uint8_t>(LogMessages::level(MESSAGE)) <=
+                                            LEVEL>(),
+               MESSAGE, time_ms, value);
+    }
+
+    //! Formats the oldest entries (and how many were dropped, if any) into the log.
+    //! \param log provides print() and println(), i.e. Serial
+    //! \return number of entries formatted
+    template <typename Log> uint8_t flush(Log &log, uint8_t max_entries = CAPACITY);
+
+    //! \return number of entries recorded but not flushed yet
+    uint8_t pending() const { return count; }
+
+    //! \return number of entries dropped in total since the buffer was full
+    uint32_t dropped() const { return dropped_total; }
+
+private:
+    struct Entry
+    {
+        uint32_t time_ms;
+        int16_t value;
+        LogMessage message;
+    };
+
+    void record(std::false_type, LogMessage, uint32_t, int16_t) {}
+
+    void record(std::true_type, LogMessage message, uint32_t time_ms, int16_t value)
+    {
+        if(count == CAPACITY)
+        {
+            ++dropped_total;
+            return;
+        }
+        entries[(first + count++) & (CAPACITY - 1)] = Entry{ time_ms, value, message };
+    }
+
+    Entry entries[CAPACITY];
+    uint32_t dropped_total{ 0 };
+    //! dropped_total as of the last flush()
+    uint32_t dropped_reported{ 0 };
+    uint8_t first{ 0 };
+    uint8_t count{ 0 };
+};
+
+template <uint8_t CAPACITY> class EventLog<CAPACITY, 0>
+{
+public:
+    static constexpr bool enabled = false;
+
+    template <LogMessage MESSAGE> void record(uint32_t, int16_t = 0) {}
+
+    template <typename Log> uint8_t flush(Log &, uint8_t = 0) { return 0; }
+
+    uint8_t pending() const { return 0; }
+
+    uint32_t dropped() const { return 0; }
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint8_t CAPACITY, uint8_t LEVEL>
+template <typename Log>
+uint8_t EventLog<CAPACITY, LEVEL>::flush(Log &log, uint8_t max_entries)
+{
+    if(dropped_total != dropped_reported)
+    {
+        log.print("EventLog: dropped ");
+        log.println(dropped_total - dropped_reported);
+        dropped_reported = dropped_total;
+    }
+
+    uint8_t flushed = 0;
+    for(; flushed < max_entries && count > 0; flushed++)
+    {
+        const Entry &entry = entries[first];
+        first = (first + 1) & (CAPACITY - 1);
+        --count;
+
+        log.print(entry.time_ms);
+        log.print(" ");
+        if(LogMessages::hasValue(entry.message))
+        {
+            log.print(LogMessages::text(entry.message));
+            log.println(entry.value);
+        }
+        else
+            log.println(LogMessages::text(entry.message));
+    }
+    return flushed;
+}
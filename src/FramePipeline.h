@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include "StripTransmission.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Renders and transmits a ring in two stages running concurrently, i.e. on the two cores of an
+//! ESP32: while frame N is transmitted from the output buffer, frame N+1 is rendered into the
+//! strip buffer of the ring. The frame period is the longer of both stages instead of their sum.
+//!
+//! A rendered frame is handed over by copying it into the output buffer, which only happens while
+//! the transmit stage is idle, so a frame is never changed while on the wire. Frames rendered
+//! while the transmit stage is busy stay pending, the newest one is handed over next.
+//!
+//!     FramePipeline<Ring> pipeline{ ring };
+//!     // transmit task, pinned to the other core
+//!     for(;;) { if(!pipeline.transmit()) vTaskDelay(1); }
+//!     // loop()
+//!     pipeline.render();
+//!
+//! \tparam Ring the PixelRing type pipelined
+template <typename Ring> class FramePipeline
+{
+public:
+    using Strip = typename Ring::Strip;
+    using Backend = typename Ring::BackendType;
+
+    struct Counters
+    {
+        //! frames handed over to the transmit stage
+        uint32_t handed_over{ 0 };
+        //! frames transmitted
+        uint32_t transmitted{ 0 };
+        //! render() calls with a frame pending while the transmit stage was busy
+        uint32_t stalls{ 0 };
+        //! time from the hand-over to the end of the transmission of the last frame in [us]
+        uint32_t last_latency_us{ 0 };
+        uint32_t max_latency_us{ 0 };
+        uint64_t total_latency_us{ 0 };
+
+        uint32_t meanLatencyUs() const
+        {
+            return transmitted ? static_cast<uint32_t>(total_latency_us / transmitted) : 0;
+        }
+    };
+
+    explicit FramePipeline(Ring &ring) : ring(ring) {}
+
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    void setup()
+    {
+        ring.setup();
+        output.begin();
+    }
+
+    //! Render stage: renders the next frame (if due) and hands it over if the transmit stage is
+    //! idle, flushes the log and the state of the ring if no frame was due, see
+    //! RingControl::idle(). Never waits for the transmit stage.
+    //! \return true if a frame was handed over
+    bool render();
+
+    //! Transmit stage: transmits the frame handed over (if any), blocks until done.
+    //! \return true if a frame was transmitted
+    bool transmit();
+
+    //! Runs both stages back to back, i.e. on a single core.
+    void process()
+    {
+        render();
+        transmit();
+    }
+
+    //! \return the strip transmitting the output buffer
+    Strip &getOutput() { return output; }
+
+    //! Counters of both stages, consistent once neither stage is running.
+    const Counters &getCounters() const { return counters; }
+
+private:
+    Ring &ring;
+    Strip output{ Ring::led_count, Ring::led_pin, Ring::led_type };
+    Counters counters;
+    //! time of the hand-over of the frame in the output buffer, written before full is set
+    uint32_t handed_over_us{ 0 };
+    //! the output buffer holds a frame not transmitted yet, owned by the transmit stage then
+    std::atomic<bool> full{ false };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> bool FramePipeline<Ring>::render()
+{
+    if(!ring.render())
+    {
+        ring.idle();
+        return false;
+    }
+
+    if(full.load(std::memory_order_acquire))
+    {
+        ++counters.stalls;
+        return false;
+    }
+
+    ring.takeFrame(output.getPixels());
+    handed_over_us = Backend::micros();
+    ++counters.handed_over;
+    full.store(true, std::memory_order_release);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> bool FramePipeline<Ring>::transmit()
+{
+    if(!full.load(std::memory_order_acquire))
+        return false;
+
+    StripTransmission<Strip>::begin(output);
+    StripTransmission<Strip>::end(output);
+
+    const uint32_t latency_us = Backend::micros() - handed_over_us;
+    counters.last_latency_us = latency_us;
+    counters.max_latency_us =
+    (latency_us > counters.max_latency_us) ? latency_us : counters.max_latency_us;
+    counters.total_latency_us += latency_us;
+    ++counters.transmitted;
+    full.store(false, std::memory_order_release);
+    return true;
+}
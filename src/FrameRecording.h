@@ -0,0 +1,445 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "PgmSpace.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Binary format of a frame recording. All numbers are little endian.
+//!
+//!     header:  'P' 'X' 'R' version pixel_count:u16 bytes_per_pixel:u8
+//!     frame:   dt_ms:varint op... End
+//!     op:      kind:2 bits | (count - 1):6 bits, count 1-64 pixels
+//!
+//! Frames are delta coded against the previous frame (the first one against all pixels off) and
+//! run length coded per pixel. Pixels are in wire byte order, i.e. as in Strip::getPixels(). The
+//! time dt_ms is relative to the previous frame (0 for the first one), varints take 7 bits per
+//! byte with the top bit set on all but the last byte.
+struct FrameFormat
+{
+    static constexpr uint8_t version = 1;
+    static constexpr uint8_t header_size = 7;
+    static constexpr uint8_t max_count = 64;
+
+    enum Kind : uint8_t
+    {
+        //! count pixels unchanged
+        Skip = 0x00,
+        //! count pixels set to the one pixel following
+        Run = 0x40,
+        //! count pixels following
+        Literal = 0x80,
+        //! end of frame, all remaining pixels unchanged
+        End = 0xc0
+    };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Encodes frames into a byte sink, i.e. an Arduino Print (File, Serial) or a HostStream.
+//! Keeps a copy of the previous frame to encode the difference.
+//!
+//!     FrameRecorder<File, Ring::led_count, Ring::bytes_per_pixel> recorder{ file };
+//!     recorder.attach(ring); // records each frame ring transmits from now on
+//!
+//! \tparam Sink provides write(uint8_t)
+template <typename Sink, uint16_t PIXEL_COUNT, uint8_t BYTES_PER_PIXEL> class FrameRecorder
+{
+public:
+    static constexpr uint16_t frame_size = PIXEL_COUNT * BYTES_PER_PIXEL;
+
+    //! Writes the header.
+    explicit FrameRecorder(Sink &sink);
+
+    //! Records each frame the ring transmits, see PixelRing::setFrameObserver().
+    template <typename Ring> void attach(Ring &ring)
+    {
+        static_assert(Ring::led_count == PIXEL_COUNT && Ring::bytes_per_pixel == BYTES_PER_PIXEL,
+                      "recorder does not match the ring");
+        ring.setFrameObserver(&FrameRecorder::observe, this);
+    }
+
+    //! Appends a frame.
+    //! \param pixels frame_size bytes in wire order
+    //! \param time_ms time of the frame, only the differences between frames are recorded
+    void record(const uint8_t *pixels, uint32_t time_ms);
+
+    //! \return number of frames recorded
+    uint32_t frames() const { return frame_count; }
+
+    //! \return number of bytes written including the header
+    uint32_t bytes() const { return byte_count; }
+
+    //! Frame observer as of PixelRing::setFrameObserver().
+    static void observe(void *recorder, const uint8_t *pixels, uint16_t, uint32_t time_ms)
+    {
+        static_cast<FrameRecorder *>(recorder)->record(pixels, time_ms);
+    }
+
+private:
+    void put(uint8_t byte)
+    {
+        sink.write(byte);
+        ++byte_count;
+    }
+
+    void putVarint(uint32_t value);
+
+    void putOp(FrameFormat::Kind kind, uint16_t count, const uint8_t *pixels);
+
+    bool equal(const uint8_t *a, const uint8_t *b) const
+    {
+        return memcmp(a, b, BYTES_PER_PIXEL) == 0;
+    }
+
+    Sink &sink;
+    uint8_t previous[frame_size] = {};
+    uint32_t previous_ms{ 0 };
+    uint32_t frame_count{ 0 };
+    uint32_t byte_count{ 0 };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Sink, uint16_t PIXEL_COUNT, uint8_t BYTES_PER_PIXEL>
+FrameRecorder<Sink, PIXEL_COUNT, BYTES_PER_PIXEL>::FrameRecorder(Sink &sink) : sink(sink)
+{
+    put('P');
+    put('X');
+    put('R');
+    put(FrameFormat::version);
+    put(static_cast<uint8_t>(PIXEL_COUNT));
+    put(static_cast<uint8_t>(PIXEL_COUNT >> 8));
+    put(BYTES_PER_PIXEL);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Sink, uint16_t PIXEL_COUNT, uint8_t BYTES_PER_PIXEL>
+void FrameRecorder<Sink, PIXEL_COUNT, BYTES_PER_PIXEL>::record(const uint8_t *pixels,
+                                                               uint32_t time_ms)
+{
+    putVarint(frame_count ? time_ms - previous_ms : 0);
+    previous_ms = time_ms;
+    ++frame_count;
+
+    uint16_t skip = 0;
+    uint16_t literal = 0;
+    for(uint16_t i = 0; i < PIXEL_COUNT;)
+    {
+        const uint8_t *pixel = &pixels[i * BYTES_PER_PIXEL];
+        if(equal(pixel, &previous[i * BYTES_PER_PIXEL]))
+        {
+            putOp(FrameFormat::Literal, literal, pixel - literal * BYTES_PER_PIXEL);
+            literal = 0;
+            ++skip;
+            ++i;
+            continue;
+        }
+
+        uint16_t run = 1;
+        while(i + run < PIXEL_COUNT && equal(pixel, pixel + run * BYTES_PER_PIXEL))
+            ++run;
+
+        putOp(FrameFormat::Skip, skip, nullptr);
+        skip = 0;
+        if(run > 1)
+        {
+            putOp(FrameFormat::Literal, literal, pixel - literal * BYTES_PER_PIXEL);
+            literal = 0;
+            putOp(FrameFormat::Run, run, pixel);
+            i += run;
+        }
+        else
+        {
+            ++literal;
+            ++i;
+        }
+    }
+    putOp(FrameFormat::Literal, literal, &pixels[(PIXEL_COUNT - literal) * BYTES_PER_PIXEL]);
+    // trailing unchanged pixels are implied by End
+    put(FrameFormat::End);
+
+    memcpy(previous, pixels, frame_size);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Sink, uint16_t PIXEL_COUNT, uint8_t BYTES_PER_PIXEL>
+void FrameRecorder<Sink, PIXEL_COUNT, BYTES_PER_PIXEL>::putVarint(uint32_t value)
+{
+    while(value >= 0x80)
+    {
+        put(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    put(static_cast<uint8_t>(value));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Sink, uint16_t PIXEL_COUNT, uint8_t BYTES_PER_PIXEL>
+void FrameRecorder<Sink, PIXEL_COUNT, BYTES_PER_PIXEL>::putOp(FrameFormat::Kind kind,
+                                                              uint16_t count,
+                                                              const uint8_t *pixels)
+{
+    while(count > 0)
+    {
+        const uint8_t chunk = (count > FrameFormat::max_count) ? FrameFormat::max_count :
+                                                                 static_cast<uint8_t>(count);
+        put(static_cast<uint8_t>(kind | (chunk - 1)));
+
+        const uint16_t pixels_following =
+        (kind == FrameFormat::Literal) ? chunk : (kind == FrameFormat::Run) ? 1 : 0;
+        for(uint16_t b = 0; b < pixels_following * BYTES_PER_PIXEL; b++)
+            put(pixels[b]);
+
+        if(kind == FrameFormat::Literal)
+            pixels += chunk * BYTES_PER_PIXEL;
+        count -= chunk;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+//! Replays a recording into a strip buffer with the recorded timing. The recording is read byte
+//! by byte as it is decoded, no frame is buffered except in the strip buffer itself.
+//!
+//!     FramePlayer<File> player{ file };
+//!     player.begin(strip.getPixels(), Ring::led_count, Ring::bytes_per_pixel, millis());
+//!     ...
+//!     if(player.poll(millis()))
+//!         strip.show();
+//!
+//! A recording arriving over a live stream (i.e. Serial) is played with live set: bytes not
+//! arrived yet are waited for, a frame decoded partially is continued by the next poll(). Such a
+//! player does not finish, begin() is to be called once the header is available.
+//!
+//! \tparam Source provides int read(), -1 if no byte is left (or none arrived yet on a live
+//! stream), i.e. an Arduino Stream, a File, a HostStream or a PgmFrameSource
+template <typename Source> class FramePlayer
+{
+public:
+    enum class Status : uint8_t
+    {
+        Playing,
+        Finished,
+        //! the recording is malformed or does not match the strip
+        Invalid
+    };
+
+    //! \param live the source is a live stream on which further bytes may arrive
+    explicit FramePlayer(Source &source, bool live = false) : source(source), live(live) {}
+
+    //! Reads the header and clears the strip buffer.
+    //! \return false if the recording does not match pixel count and bytes per pixel
+    bool begin(uint8_t *pixels, uint16_t pixel_count, uint8_t bytes_per_pixel, uint32_t now_ms);
+
+    //! Decodes the next frame into the strip buffer if it is due, as far as the bytes available
+    //! allow on a live stream.
+    //! \return true if the strip buffer changed and is to be shown
+    bool poll(uint32_t now_ms);
+
+    Status status() const { return current_status; }
+
+    //! \return number of frames decoded
+    uint32_t frames() const { return frame_count; }
+
+private:
+    enum class State : uint8_t
+    {
+        //! reading the time of the next frame
+        Delay,
+        //! waiting for the next frame to be due
+        Due,
+        Op,
+        //! reading the pixel of a run or the pixels of a literal
+        Payload
+    };
+
+    //! \return true if the byte completed a frame
+    bool parse(uint8_t byte);
+
+    void fail() { current_status = Status::Invalid; }
+
+    Source &source;
+    uint8_t *pixels{ nullptr };
+    uint16_t pixel_count{ 0 };
+    uint8_t bytes_per_pixel{ 0 };
+    //! time the next frame is due at, relative to begin()
+    uint32_t due_ms{ 0 };
+    uint32_t start_ms{ 0 };
+    uint32_t frame_count{ 0 };
+    //! time of the next frame read so far and the bit position of the next varint byte
+    uint32_t delay_ms{ 0 };
+    uint8_t shift{ 0 };
+    //! first pixel of the current op, its pixel count and the bytes of its payload read so far
+    uint16_t pixel{ 0 };
+    uint8_t count{ 0 };
+    uint16_t payload{ 0 };
+    bool run{ false };
+    const bool live;
+    State state{ State::Delay };
+    Status current_status{ Status::Invalid };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Source>
+bool FramePlayer<Source>::begin(uint8_t *new_pixels,
+                                uint16_t new_pixel_count,
+                                uint8_t new_bytes_per_pixel,
+                                uint32_t now_ms)
+{
+    uint8_t header[FrameFormat::header_size];
+    for(uint8_t &byte : header)
+    {
+        const int value = source.read();
+        if(value < 0)
+        {
+            fail();
+            return false;
+        }
+        byte = static_cast<uint8_t>(value);
+    }
+
+    const uint16_t recorded_pixels = static_cast<uint16_t>(header[4] | (header[5] << 8));
+    if(header[0] != 'P' || header[1] != 'X' || header[2] != 'R' ||
+       header[3] != FrameFormat::version || recorded_pixels != new_pixel_count ||
+       header[6] != new_bytes_per_pixel)
+    {
+        fail();
+        return false;
+    }
+
+    pixels = new_pixels;
+    pixel_count = new_pixel_count;
+    bytes_per_pixel = new_bytes_per_pixel;
+    memset(pixels, 0, pixel_count * bytes_per_pixel);
+    start_ms = now_ms;
+    due_ms = 0;
+    frame_count = 0;
+    delay_ms = 0;
+    shift = 0;
+    state = State::Delay;
+    current_status = Status::Playing;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Source> bool FramePlayer<Source>::poll(uint32_t now_ms)
+{
+    while(current_status == Status::Playing)
+    {
+        if(state == State::Due)
+        {
+            if(now_ms - start_ms < due_ms)
+                return false;
+            pixel = 0;
+            state = State::Op;
+        }
+
+        const int value = source.read();
+        if(value < 0)
+        {
+            // the end of a recording is fine between frames only, a live stream may continue
+            if(!live)
+                current_status = (state == State::Delay && shift == 0) ? Status::Finished :
+                                                                          Status::Invalid;
+            return false;
+        }
+
+        if(parse(static_cast<uint8_t>(value)))
+        {
+            ++frame_count;
+            return true;
+        }
+    }
+    return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Source> bool FramePlayer<Source>::parse(uint8_t byte)
+{
+    switch(state)
+    {
+    case State::Delay:
+        delay_ms |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        shift = static_cast<uint8_t>(shift + 7);
+        if(byte & 0x80)
+        {
+            if(shift >= 35)
+                fail();
+            break;
+        }
+        due_ms += delay_ms;
+        delay_ms = 0;
+        shift = 0;
+        state = State::Due;
+        break;
+    case State::Op:
+    {
+        const uint8_t kind = byte & 0xc0;
+        if(kind == FrameFormat::End)
+        {
+            state = State::Delay;
+            return true;
+        }
+
+        count = static_cast<uint8_t>((byte & 0x3f) + 1);
+        if(pixel + count > pixel_count)
+        {
+            fail();
+            break;
+        }
+        if(kind == FrameFormat::Skip)
+        {
+            pixel += count;
+            break;
+        }
+        run = (kind == FrameFormat::Run);
+        payload = 0;
+        state = State::Payload;
+        break;
+    }
+    case State::Payload:
+    {
+        uint8_t *target = &pixels[pixel * bytes_per_pixel];
+        target[payload++] = byte;
+        if(payload < (run ? bytes_per_pixel : count * bytes_per_pixel))
+            break;
+
+        if(run)
+        {
+            for(uint16_t p = 1; p < count; p++)
+                memcpy(&target[p * bytes_per_pixel], target, bytes_per_pixel);
+        }
+        pixel += count;
+        state = State::Op;
+        break;
+    }
+    case State::Due:
+        // not read while waiting, see poll()
+        break;
+    }
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+//! Recording stored in flash, i.e. a PROGMEM array generated from a recorded file.
+struct PgmFrameSource
+{
+    PgmFrameSource(const uint8_t *data, uint32_t size) : data(data), size(size) {}
+
+    int read() { return (position < size) ? pgm_read_byte(&data[position++]) : -1; }
+
+    void rewind() { position = 0; }
+
+    const uint8_t *data;
+    uint32_t size;
+    uint32_t position{ 0 };
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Frames to be rendered on a poll of the FrameScheduler.
+struct FrameTick
+{
+    //! number of frames to render, 0 if no frame is due
+    uint8_t frames{ 0 };
+    //! time each frame advances the animation in [ms]
+    uint16_t period_ms{ 0 };
+    //! time of frames due but not rendered in [ms]; the last frame advances by this in addition
+    uint32_t skipped_ms{ 0 };
+
+    //! \return time the given frame (0...frames-1) advances the animation in [ms]
+    uint32_t dtMs(uint8_t frame) const
+    {
+        return period_ms + ((frame + 1 == frames) ? skipped_ms : 0);
+    }
+
+    //! \return dtMs() clamped to the range of the scenes' dt_ms, i.e. a stall of more than 65 s
+    //! advances the animation by 65 s only rather than by its duration modulo 65536 ms
+    uint16_t sceneDtMs(uint8_t frame) const
+    {
+        const uint32_t dt_ms = dtMs(frame);
+        return (dt_ms > UINT16_MAX) ? UINT16_MAX : static_cast<uint16_t>(dt_ms);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Time based frame scheduler. Frames are due on a fixed grid of 1000/fps [ms], independent of
+//! how often and how regularly poll() is called. Frames which are overdue are either dropped
+//! (their time is added to the next rendered frame) or caught up (rendered back to back) up to a
+//! limit. Either way the animation time advances exactly by the elapsed time.
+//!
+//! \tparam Clock provides static uint32_t millis(), i.e. the PixelRing backend
+template <typename Clock> class FrameScheduler
+{
+public:
+    enum class Policy
+    {
+        //! renders a single frame which advances by all due frame periods
+        Drop,
+        //! renders each due frame, up to max_catch_up frames per poll()
+        CatchUp
+    };
+
+    FrameScheduler(uint16_t fps = 100) { setTargetFps(fps); }
+
+    //! \param fps frames per second, the frame period is rounded down to full [ms]
+    void setTargetFps(uint16_t fps);
+
+    //! \param max_catch_up number of frames rendered per poll() at most if policy is CatchUp
+    void setPolicy(Policy new_policy, uint8_t max_catch_up = 4);
+
+    //! Makes the next poll() return a frame immediately and restarts the frame grid from there.
+    void restart() { started = false; }
+
+    //! \return frames to be rendered now
+    FrameTick poll();
+
+    uint16_t getTargetFps() const { return 1000 / period_ms; }
+
+    uint16_t getPeriodMs() const { return period_ms; }
+
+    //! \return frames rendered within the last full second
+    uint16_t getActualFps() const { return actual_fps; }
+
+    //! \return frames due but not rendered in total
+    uint32_t getDroppedFrames() const { return dropped_frames; }
+
+private:
+    uint32_t next_frame_ms{ 0 };
+    uint32_t window_start_ms{ 0 };
+    uint32_t dropped_frames{ 0 };
+    uint16_t period_ms{ 10 };
+    uint16_t window_frames{ 0 };
+    uint16_t actual_fps{ 0 };
+    Policy policy{ Policy::Drop };
+    uint8_t max_catch_up{ 4 };
+    bool started{ false };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Clock> void FrameScheduler<Clock>::setTargetFps(uint16_t fps)
+{
+    period_ms = (fps == 0 || fps > 1000) ? 1 : 1000 / fps;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Clock>
+void FrameScheduler<Clock>::setPolicy(Policy new_policy, uint8_t new_max_catch_up)
+{
+    policy = new_policy;
+    max_catch_up = (new_max_catch_up == 0) ? 1 : new_max_catch_up;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Clock> FrameTick FrameScheduler<Clock>::poll()
+{
+    const uint32_t now = Clock::millis();
+    FrameTick tick;
+
+    if(!started)
+    {
+        started = true;
+        next_frame_ms = now;
+        window_start_ms = now;
+        window_frames = 0;
+    }
+
+    if(static_cast<int32_t>(now - next_frame_ms) < 0)
+        return tick;
+
+    const uint32_t due = (now - next_frame_ms) / period_ms + 1;
+    next_frame_ms += due * period_ms;
+
+    const uint32_t frames =
+    (policy == Policy::Drop) ? 1 : ((due < max_catch_up) ? due : max_catch_up);
+    tick.frames = static_cast<uint8_t>(frames);
+    tick.period_ms = period_ms;
+    tick.skipped_ms = (due - frames) * period_ms;
+    dropped_frames += due - frames;
+
+    window_frames += tick.frames;
+    if(now - window_start_ms >= 1000)
+    {
+        actual_fps = static_cast<uint16_t>(window_frames * 1000UL / (now - window_start_ms));
+        window_start_ms = now;
+        window_frames = 0;
+    }
+
+    return tick;
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <stdint.h>
+#include "FrameScheduler.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Minimum, maximum, mean and a histogram of durations.
+struct DurationStats
+{
+    //! bin 0 counts durations of 0 [us], bin i durations in [2^(i-1), 2^i) [us], the last bin
+    //! all durations beyond
+    static constexpr uint8_t bins = 16;
+
+    static uint8_t bin(uint32_t us)
+    {
+        uint8_t i = 0;
+        while(us != 0 && i < bins - 1)
+        {
+            us >>= 1;
+            ++i;
+        }
+        return i;
+    }
+
+    void add(uint32_t us)
+    {
+        min_us = (count == 0 || us < min_us) ? us : min_us;
+        max_us = (us > max_us) ? us : max_us;
+        total_us += us;
+        ++count;
+        uint16_t &hits = histogram[bin(us)];
+        hits = (hits == UINT16_MAX) ? hits : static_cast<uint16_t>(hits + 1);
+    }
+
+    uint32_t meanUs() const { return count ? static_cast<uint32_t>(total_us / count) : 0; }
+
+    uint32_t count{ 0 };
+    uint32_t min_us{ 0 };
+    uint32_t max_us{ 0 };
+    uint64_t total_us{ 0 };
+    //! saturating counts per bin
+    uint16_t histogram[bins] = {};
+};
+
+//--------------------------------------------------------------------------------------------------
+
+struct SceneStats
+{
+    //! time to render a frame, including frames skipped
+    DurationStats render;
+    //! time blocked in transmitting a frame
+    DurationStats transmit;
+    //! frames transmitted
+    uint32_t emitted{ 0 };
+    //! frames due but not transmitted since identical to the previous one
+    uint32_t skipped{ 0 };
+    //! frames which were not rendered in time: steps of the scene dropped or caught up by the
+    //! scheduler and frames whose rendering and transmission took longer than a step. The step is
+    //! the scene's own (see SceneList), the frame period for scenes without or with shorter ones.
+    uint32_t missed_deadlines{ 0 };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Per scene timing and frame counters of a PixelRing, fed along the frame pipeline: tick() once
+//! per scheduler tick, rendered() per frame rendered and transmitting() / transmitted() around the
+//! transmission. Instantiated with ENABLED false (see PIXELRING_INSTRUMENTATION) it neither takes
+//! RAM nor time.
+//! \tparam SCENE_COUNT number of scenes in the scene list
+template <uint8_t SCENE_COUNT, bool ENABLED = true> class FrameStats
+{
+public:
+    static constexpr bool enabled = true;
+
+    //! Starts the frames of a scheduler tick.
+    //! \param step_ms interval the scene advances in, 0 if it has none
+    void tick(uint8_t scene, const FrameTick &frame_tick, uint16_t step_ms = 0)
+    {
+        close();
+        const uint32_t deadline_ms =
+        (step_ms > frame_tick.period_ms) ? step_ms : frame_tick.period_ms;
+        frame_scene = scene;
+        frame_us = 0;
+        deadline_us = deadline_ms * 1000UL;
+        frame_open = true;
+        // the frames beyond the first one were overdue, by so many steps
+        scenes[scene].missed_deadlines +=
+        ((frame_tick.frames - 1U) * frame_tick.period_ms + frame_tick.skipped_ms) / deadline_ms;
+    }
+
+    void rendered(uint32_t us, bool skipped)
+    {
+        scenes[frame_scene].render.add(us);
+        scenes[frame_scene].skipped += skipped ? 1 : 0;
+        frame_us += us;
+    }
+
+    //! Adds time blocked in starting a transmission.
+    void transmitting(uint32_t us) { transmit_us += us; }
+
+    //! Completes a transmission.
+    void transmitted(uint32_t us)
+    {
+        scenes[frame_scene].transmit.add(transmit_us + us);
+        ++scenes[frame_scene].emitted;
+        frame_us += transmit_us + us;
+        transmit_us = 0;
+        close();
+    }
+
+    const SceneStats &scene(uint8_t index) const { return scenes[index]; }
+
+    void reset()
+    {
+        for(SceneStats &stats : scenes)
+            stats = SceneStats{};
+    }
+
+    //! Prints a line per scene which rendered frames, and its histograms.
+    template <typename Log> void dump(Log &log) const;
+
+private:
+    template <typename Log> static void dump(Log &log, const char *name, const DurationStats &d);
+
+    //! Checks the deadline of the frame, once.
+    void close()
+    {
+        if(frame_open && frame_us > deadline_us)
+            ++scenes[frame_scene].missed_deadlines;
+        frame_open = false;
+    }
+
+    SceneStats scenes[SCENE_COUNT];
+    //! render and transmit time of the current frame
+    uint32_t frame_us{ 0 };
+    uint32_t transmit_us{ 0 };
+    uint32_t deadline_us{ 0 };
+    uint8_t frame_scene{ 0 };
+    bool frame_open{ false };
+};
+
+template <uint8_t SCENE_COUNT> class FrameStats<SCENE_COUNT, false>
+{
+public:
+    static constexpr bool enabled = false;
+
+    void tick(uint8_t, const FrameTick &, uint16_t = 0) {}
+
+    void rendered(uint32_t, bool) {}
+
+    void transmitting(uint32_t) {}
+
+    void transmitted(uint32_t) {}
+
+    const SceneStats &scene(uint8_t) const
+    {
+        static const SceneStats none;
+        return none;
+    }
+
+    void reset() {}
+
+    template <typename Log> void dump(Log &) const {}
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint8_t SCENE_COUNT, bool ENABLED>
+template <typename Log>
+void FrameStats<SCENE_COUNT, ENABLED>::dump(Log &log) const
+{
+    for(uint8_t i = 0; i < SCENE_COUNT; i++)
+    {
+        const SceneStats &stats = scenes[i];
+        if(stats.render.count == 0)
+            continue;
+
+        log.print("scene ");
+        log.print(static_cast<uint32_t>(i));
+        log.print(": emitted ");
+        log.print(stats.emitted);
+        log.print(" skipped ");
+        log.print(stats.skipped);
+        log.print(" missed ");
+        log.println(stats.missed_deadlines);
+        dump(log, "  render", stats.render);
+        dump(log, "  transmit", stats.transmit);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint8_t SCENE_COUNT, bool ENABLED>
+template <typename Log>
+void FrameStats<SCENE_COUNT, ENABLED>::dump(Log &log, const char *name, const DurationStats &d)
+{
+    log.print(name);
+    log.print(" us min/mean/max ");
+    log.print(d.min_us);
+    log.print("/");
+    log.print(d.meanUs());
+    log.print("/");
+    log.print(d.max_us);
+    log.print(" histogram");
+    for(uint8_t bin = 0; bin < DurationStats::bins; bin++)
+    {
+        log.print(" ");
+        log.print(static_cast<uint32_t>(d.histogram[bin]));
+    }
+    log.println("");
+}
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Mirrors the pixel type encoding of Adafruit_NeoPixel so that PixelRing can be instantiated
+// with the very same LED_TYPE on the host.
+#ifndef NEO_KHZ400
+typedef uint16_t neoPixelType;
+
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_WRGB ((0 << 6) | (1 << 4) | (2 << 2) | (3))
+#define NEO_RGBW ((3 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRBW ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+#endif
+
+#ifndef D0
+#define D0 0
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+//! Injectable millisecond clock used by the host backend.
+//! By default the time only advances if told so which makes simulations deterministic.
+struct HostClock
+{
+    using Source = uint32_t (*)();
+
+    //! \return current time in [ms]
+    static uint32_t millis() { return source() ? source()() : now(); }
+
+    //! Sets the current (manual) time.
+    static void set(uint32_t ms) { now() = ms; }
+
+    //! Advances the current (manual) time.
+    static void advance(uint32_t ms) { now() += ms; }
+
+    //! Replaces the manual time by the given function, nullptr restores the manual time.
+    static void setSource(Source new_source) { source() = new_source; }
+
+private:
+    static uint32_t &now()
+    {
+        static uint32_t ms{ 0 };
+        return ms;
+    }
+
+    static Source &source()
+    {
+        static Source fn{ nullptr };
+        return fn;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Diagnostic sink; messages are dropped unless a stream is assigned.
+struct HostLog
+{
+    template <typename T> void print(const T &value)
+    {
+        if(stream)
+            *stream << value;
+    }
+
+    template <typename T> void println(const T &value)
+    {
+        if(stream)
+            *stream << value << std::endl;
+    }
+
+    std::ostream *stream{ nullptr };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! In-memory byte stream, interface compatible to an Arduino Stream (or File) as far as the
+//! library reads and writes byte streams: written bytes are appended, read bytes are consumed.
+struct HostStream
+{
+    size_t write(uint8_t byte)
+    {
+        bytes.push_back(byte);
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + size);
+        return size;
+    }
+
+    int available() const { return static_cast<int>(bytes.size() - position); }
+
+    int read() { return (position < bytes.size()) ? bytes[position++] : -1; }
+
+    int peek() const { return (position < bytes.size()) ? bytes[position] : -1; }
+
+    //! Restarts reading from the first byte.
+    void rewind() { position = 0; }
+
+    std::vector<uint8_t> bytes;
+    size_t position{ 0 };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Storage backed by a file, interface compatible to EepromStorage, i.e. to keep the StateStore of
+//! a simulated ring across runs. The file is read at construction and rewritten on each write,
+//! bytes never written read as erased (0xff).
+struct HostFileStorage
+{
+    explicit HostFileStorage(const std::string &path) : path(path)
+    {
+        if(FILE *file = std::fopen(path.c_str(), "rb"))
+        {
+            int byte;
+            while((byte = std::fgetc(file)) != EOF)
+                bytes.push_back(static_cast<uint8_t>(byte));
+            std::fclose(file);
+        }
+    }
+
+    bool read(uint16_t address, uint8_t *data, uint16_t size)
+    {
+        for(uint16_t i = 0; i < size; i++)
+            data[i] = (address + i < bytes.size()) ? bytes[address + i] : 0xff;
+        return true;
+    }
+
+    bool write(uint16_t address, const uint8_t *data, uint16_t size)
+    {
+        if(bytes.size() < static_cast<size_t>(address + size))
+            bytes.resize(address + size, 0xff);
+        std::memcpy(&bytes[address], data, size);
+        ++writes;
+
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if(!file)
+            return false;
+        const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        return (std::fclose(file) == 0) && written;
+    }
+
+    std::string path;
+    std::vector<uint8_t> bytes;
+    //! number of write() calls, i.e. flash sector erases on an ESP8266
+    uint32_t writes{ 0 };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Simulated strip, interface compatible to Adafruit_NeoPixel as far as PixelRing uses it.
+//! Each show() is counted and (optionally) captured into an in-memory frame log.
+class HostStrip
+{
+public:
+    struct Frame
+    {
+        //! HostClock time at show() in [ms]
+        uint32_t time_ms;
+        //! pixel buffer in wire byte order
+        std::vector<uint8_t> pixels;
+    };
+
+    HostStrip(uint16_t n, uint8_t pin = D0, neoPixelType type = NEO_GRB + NEO_KHZ800)
+    : pixels(n * (((type >> 6) & 0x03) == ((type >> 4) & 0x03) ? 3 : 4), 0), num_leds(n),
+      pin(pin), w_offset((type >> 6) & 0x03), r_offset((type >> 4) & 0x03),
+      g_offset((type >> 2) & 0x03), b_offset(type & 0x03)
+    {
+    }
+
+    void begin() { begun = true; }
+
+    void show()
+    {
+        ++show_count;
+        if(record)
+            frames.push_back({ HostClock::millis(), pixels });
+        if(wire_time)
+            std::this_thread::sleep_for(std::chrono::microseconds(wireTimeUs()));
+    }
+
+    void clear() { std::memset(pixels.data(), 0, pixels.size()); }
+
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0)
+    {
+        if(n >= num_leds)
+            return;
+        uint8_t *p = &pixels[n * bytesPerPixel()];
+        p[r_offset] = r;
+        p[g_offset] = g;
+        p[b_offset] = b;
+        if(bytesPerPixel() == 4)
+            p[w_offset] = w;
+    }
+
+    void setPixelColor(uint16_t n, uint32_t c)
+    {
+        setPixelColor(n, static_cast<uint8_t>(c >> 16), static_cast<uint8_t>(c >> 8),
+                      static_cast<uint8_t>(c), static_cast<uint8_t>(c >> 24));
+    }
+
+    void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0)
+    {
+        uint16_t last = (count == 0 || first + count > num_leds) ? num_leds : first + count;
+        for(uint16_t i = first; i < last; i++)
+            setPixelColor(i, c);
+    }
+
+    uint32_t getPixelColor(uint16_t n) const
+    {
+        if(n >= num_leds)
+            return 0;
+        const uint8_t *p = &pixels[n * bytesPerPixel()];
+        uint32_t w = (bytesPerPixel() == 4) ? p[w_offset] : 0;
+        return (w << 24) | (static_cast<uint32_t>(p[r_offset]) << 16) |
+               (static_cast<uint32_t>(p[g_offset]) << 8) | p[b_offset];
+    }
+
+    uint8_t *getPixels() { return pixels.data(); }
+
+    uint16_t numPixels() const { return num_leds; }
+
+    uint8_t getPin() const { return pin; }
+
+    void setPin(uint8_t new_pin) { pin = new_pin; }
+
+    //----------------------------------------------------------------------------------------------
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+    }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w)
+    {
+        return (static_cast<uint32_t>(w) << 24) | Color(r, g, b);
+    }
+
+    //! Same hue model as Adafruit_NeoPixel::ColorHSV: 0-65535 covers the whole color wheel.
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255)
+    {
+        uint8_t r, g, b;
+        hue = static_cast<uint16_t>((hue * 1530L + 32768) / 65536);
+
+        if(hue < 510) // red to green
+        {
+            b = 0;
+            r = (hue < 255) ? 255 : static_cast<uint8_t>(510 - hue);
+            g = (hue < 255) ? static_cast<uint8_t>(hue) : 255;
+        }
+        else if(hue < 1020) // green to blue
+        {
+            r = 0;
+            g = (hue < 765) ? 255 : static_cast<uint8_t>(1020 - hue);
+            b = (hue < 765) ? static_cast<uint8_t>(hue - 510) : 255;
+        }
+        else if(hue < 1530) // blue to red
+        {
+            g = 0;
+            r = (hue < 1275) ? static_cast<uint8_t>(hue - 1020) : 255;
+            b = (hue < 1275) ? 255 : static_cast<uint8_t>(1530 - hue);
+        }
+        else // hue rounded up to 1530
+        {
+            r = 255;
+            g = b = 0;
+        }
+
+        uint32_t v1 = 1 + val;
+        uint16_t s1 = 1 + sat;
+        uint8_t s2 = 255 - sat;
+        return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+               (((((g * s1) >> 8) + s2) * v1) & 0xff00) | (((((b * s1) >> 8) + s2) * v1) >> 8);
+    }
+
+    //! Gamma 2.6 correction as applied by Adafruit_NeoPixel::gamma8.
+    static uint8_t gamma8(uint8_t x)
+    {
+        static uint8_t table[256];
+        static bool initialized = false;
+        if(!initialized)
+        {
+            for(uint16_t i = 0; i < 256; i++)
+                table[i] = static_cast<uint8_t>(std::pow(i / 255.0, 2.6) * 255.0 + 0.5);
+            initialized = true;
+        }
+        return table[x];
+    }
+
+    static uint32_t gamma32(uint32_t x)
+    {
+        uint8_t *y = reinterpret_cast<uint8_t *>(&x);
+        for(uint8_t i = 0; i < 4; i++)
+            y[i] = gamma8(y[i]);
+        return x;
+    }
+
+    //----------------------------------------------------------------------------------------------
+
+    uint8_t bytesPerPixel() const { return (w_offset == r_offset) ? 3 : 4; }
+
+    //! \return number of show() calls since construction or resetFrames()
+    uint32_t showCount() const { return show_count; }
+
+    //! \return captured frames since construction or resetFrames()
+    const std::vector<Frame> &getFrames() const { return frames; }
+
+    //! Enables/disables capturing of frames; counting show() is not affected.
+    void recordFrames(bool enable) { record = enable; }
+
+    //! Makes show() take as long as a WS2812 strip at 800 kHz does, sleeping meanwhile.
+    void simulateWireTime(bool enable) { wire_time = enable; }
+
+    //! \return duration of show() on a WS2812 strip: 1.25 [us] per bit plus the reset of 300 [us]
+    uint32_t wireTimeUs() const { return num_leds * bytesPerPixel() * 8 * 5 / 4 + 300; }
+
+    void resetFrames()
+    {
+        frames.clear();
+        show_count = 0;
+    }
+
+    bool isBegun() const { return begun; }
+
+private:
+    std::vector<uint8_t> pixels;
+    std::vector<Frame> frames;
+    uint32_t show_count{ 0 };
+    uint16_t num_leds;
+    uint8_t pin;
+    uint8_t w_offset, r_offset, g_offset, b_offset;
+    bool record{ true };
+    bool begun{ false };
+    bool wire_time{ false };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Output backend for simulation and benchmarking on a host (i.e. Linux).
+struct HostBackend
+{
+    using Strip = HostStrip;
+
+    static HostLog &log()
+    {
+        static HostLog sink;
+        return sink;
+    }
+
+    //! \return simulated time in [ms], see HostClock
+    static uint32_t millis() { return HostClock::millis(); }
+
+    //! \return real (not simulated) time in [us], used for profiling
+    static uint32_t micros()
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+    }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Times code for the benchmark examples. Host only.
+//!
+//!     const double ns_per_frame = HostBenchmark::nsPer(frames, [&]() {
+//!         for(uint32_t f = 0; f < frames; f++)
+//!             ring.render(tick);
+//!     }, 20);
+struct HostBenchmark
+{
+    //! Runs the function repeatedly, the fastest run counts: runs interrupted by the machine are
+    //! slower, never faster.
+    //! \param count number of operations per run of the function
+    //! \param repetitions number of runs
+    //! \return time per operation of the fastest run in [ns]
+    template <typename Function>
+    static double nsPer(uint32_t count, const Function &function, uint8_t repetitions = 1)
+    {
+        double best = 0;
+        for(uint8_t r = 0; r < repetitions; r++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+            const double ns = static_cast<double>(elapsed.count()) / count;
+            best = (r == 0 || ns < best) ? ns : best;
+        }
+        return best;
+    }
+};
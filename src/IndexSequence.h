@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Compile time index sequence 0, 1, ..., N-1 (std::index_sequence is not available in C++11).
+template <uint16_t... I> struct IndexSequence
+{
+};
+
+template <typename LHS, typename RHS> struct ConcatIndexSequence;
+
+template <uint16_t... L, uint16_t... R>
+struct ConcatIndexSequence<IndexSequence<L...>, IndexSequence<R...>>
+{
+    using type = IndexSequence<L..., (sizeof...(L) + R)...>;
+};
+
+//! Builds the sequence by halving which keeps the instantiation depth at log2(N).
+template <uint16_t N> struct MakeIndexSequence
+{
+    using type = typename ConcatIndexSequence<typename MakeIndexSequence<N / 2>::type,
+                                              typename MakeIndexSequence<N - N / 2>::type>::type;
+};
+
+template <> struct MakeIndexSequence<0>
+{
+    using type = IndexSequence<>;
+};
+
+template <> struct MakeIndexSequence<1>
+{
+    using type = IndexSequence<0>;
+};
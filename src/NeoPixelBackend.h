@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Adafruit_NeoPixel.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Output backend driving a physical strip by means of Adafruit_NeoPixel.
+struct NeoPixelBackend
+{
+    //! strip implementation (see Adafruit_NeoPixel for the expected interface)
+    using Strip = Adafruit_NeoPixel;
+    //! \return the sink for diagnostic messages
+    static Print &log() { return Serial; }
+
+    //! \return time in [ms], used for scheduling frames
+    static uint32_t millis() { return ::millis(); }
+
+    //! \return time in [us], used for profiling
+    static uint32_t micros() { return ::micros(); }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Compact framebuffer: one palette index per pixel and a small palette of packed 0xWWRRGGBB
+//! colors, i.e. 1 byte per pixel rather than the 3 or 4 bytes of a strip buffer. Changing or
+//! rotating the palette animates all pixels referring to it for O(palette) work. The indices are
+//! expanded into wire bytes only right before the frame is transmitted, see expand().
+//!
+//! \tparam LED_COUNT number of pixels
+//! \tparam PALETTE_SIZE number of colors, 2-256
+template <uint16_t LED_COUNT, uint16_t PALETTE_SIZE = 16> class PaletteFrame
+{
+    static_assert(PALETTE_SIZE >= 2 && PALETTE_SIZE <= 256, "PALETTE_SIZE must be 2-256");
+
+public:
+    static constexpr uint16_t led_count = LED_COUNT;
+    static constexpr uint16_t palette_size = PALETTE_SIZE;
+
+    //! \param index palette entry, taken modulo PALETTE_SIZE
+    void setIndex(uint16_t pixel, uint8_t index)
+    {
+        if(pixel < LED_COUNT)
+            indices[pixel] = static_cast<uint8_t>(index % PALETTE_SIZE);
+    }
+
+    uint8_t getIndex(uint16_t pixel) const { return indices[pixel]; }
+
+    //! Sets count pixels from begin on to the given palette entry.
+    void fill(uint8_t index, uint16_t begin = 0, uint16_t count = LED_COUNT)
+    {
+        const uint16_t end = (count > LED_COUNT - begin) ? LED_COUNT : begin + count;
+        if(begin < end)
+            memset(&indices[begin], index % PALETTE_SIZE, end - begin);
+    }
+
+    //! \param entry palette entry, taken modulo PALETTE_SIZE
+    void setColor(uint8_t entry, uint32_t color) { colors[entry % PALETTE_SIZE] = color; }
+
+    uint32_t getColor(uint8_t entry) const { return colors[entry % PALETTE_SIZE]; }
+
+    //! Rotates the palette: pixels of index i show the color of entry i + steps afterwards.
+    void rotate(int16_t steps)
+    {
+        const int16_t size = PALETTE_SIZE;
+        rotation = static_cast<uint8_t>((rotation + size + steps % size) % size);
+    }
+
+    uint8_t getRotation() const { return rotation; }
+
+    //! \return the color shown by the given pixel wrt. to the rotation, without brightness
+    uint32_t color(uint16_t pixel) const
+    {
+        return colors[(indices[pixel] + rotation) % PALETTE_SIZE];
+    }
+
+    //! Expands the frame into wire bytes, i.e. into a strip buffer, with the layers composited
+    //! over it. The palette is rotated, blended, scaled and encoded once into a table, each pixel
+    //! is then a copy of its table entry, see Compositor::composeIndexed().
+    //! \tparam Span wire byte layout, see PixelSpan
+    //! \param pixels buffer of LED_COUNT pixels
+    //! \param layers Compositor of LED_COUNT pixels, which holds the brightness scale as well
+    template <typename Span, typename Layers>
+    void expand(uint8_t *pixels, const Layers &layers) const
+    {
+        layers.template composeIndexed<Span, PALETTE_SIZE>(
+        pixels, indices,
+        [this](uint8_t entry) { return colors[(entry + rotation) % PALETTE_SIZE]; });
+    }
+
+private:
+    uint8_t indices[LED_COUNT]{};
+    uint32_t colors[PALETTE_SIZE]{};
+    uint8_t rotation{ 0 };
+};
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "PaletteFrame.h"
+#include "PaletteScenes.h"
+#include "PixelRing.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Strip buffer a PaletteRing expands its frame into right before transmitting it, see
+//! PaletteOutput and MultiplexedPaletteOutput.
+//!
+//! \tparam LED_COUNT number of pixels of the longest ring; pixels beyond a shorter ring are off
+//! \tparam LED_PIN data pin, a placeholder if MULTIPLEXED
+//! \tparam LED_TYPE pixel type of all rings, see Adafruit_NeoPixel
+//! \tparam Backend provides the Strip, millis(), micros() and log(), see NeoPixelBackend
+//! \tparam MULTIPLEXED whether rings on several pins share the output
+template <uint16_t LED_COUNT,
+          uint8_t LED_PIN,
+          neoPixelType LED_TYPE,
+          typename Backend,
+          bool MULTIPLEXED>
+class BasicPaletteOutput
+{
+public:
+    using BackendType = Backend;
+    using Strip = typename Backend::Strip;
+    //! layout of the strip buffer
+    using Pixels = PixelSpan<LED_TYPE>;
+
+    static constexpr uint16_t led_count = LED_COUNT;
+    static constexpr uint8_t led_pin = LED_PIN;
+    static constexpr bool multiplexed = MULTIPLEXED;
+
+    //! Begins the strip, once for all rings.
+    //! \param pin data pin of the ring set up, driven rather than the placeholder if MULTIPLEXED
+    void setup(uint8_t pin)
+    {
+        if(begun)
+            return;
+        select(pin);
+        strip.begin();
+        begun = true;
+    }
+
+    //! Turns all pixels off, blocks until transmitted.
+    void clear(uint8_t pin);
+
+    //! Expands the frame with the layers composited over it into the strip buffer and transmits
+    //! it, blocks until done.
+    template <typename Frame, typename Layers>
+    void show(const Frame &frame, const Layers &layers, uint8_t pin);
+
+    //! \return the strip, i.e. to inspect the frame log of a simulated strip
+    Strip &getStrip() { return strip; }
+
+private:
+    //! Switches a multiplexed output to the given pin.
+    void select(uint8_t pin)
+    {
+        if(MULTIPLEXED && strip.getPin() != pin)
+            strip.setPin(pin);
+    }
+
+    Strip strip{ LED_COUNT, LED_PIN, LED_TYPE };
+    bool begun{ false };
+};
+
+//! Output of a single PaletteRing on LED_PIN.
+template <uint16_t LED_COUNT,
+          uint8_t LED_PIN,
+          neoPixelType LED_TYPE = NEO_GRB + NEO_KHZ400,
+          typename Backend = DefaultPixelRingBackend>
+using PaletteOutput = BasicPaletteOutput<LED_COUNT, LED_PIN, LED_TYPE, Backend, false>;
+
+//! Output shared by PaletteRing instances on several pins, so that N rings of L pixels take
+//! N * L bytes of palette indices plus a single strip buffer rather than N strip buffers. Rings
+//! sharing the output are transmitted one after another.
+//!
+//! Needs extra hardware: a pull-down resistor (i.e. 10 kOhm to GND) on each data line. The pin is
+//! switched by Strip::setPin(), which leaves the pin switched away from as a floating input; the
+//! pixels on it may take noise for data without the pull-down.
+template <uint16_t LED_COUNT,
+          neoPixelType LED_TYPE = NEO_GRB + NEO_KHZ400,
+          typename Backend = DefaultPixelRingBackend>
+using MultiplexedPaletteOutput = BasicPaletteOutput<LED_COUNT, D0, LED_TYPE, Backend, true>;
+
+//--------------------------------------------------------------------------------------------------
+
+//! Ring rendering into a PaletteFrame rather than a strip buffer, i.e. for long strips on an
+//! ESP8266 where RAM is the limit. Scenes animate the palette rather than the pixels, see
+//! PaletteScenes.h. The control (brightness, arc, scenes, commands, stats, log and state) is that
+//! of RingControl; the layers are composited over the palette when the frame is expanded into the
+//! output. Scene transitions, which would take two more frames, and streaming are not supported,
+//! use PixelRing for these.
+//!
+//!     PaletteOutput<300, D1> output;
+//!     PaletteRing<300, D1, PaletteOutput<300, D1>> ring{ output };
+//!
+//! Rings can be driven by a PixelRingGroup as well.
+//!
+//! \tparam LED_COUNT number of pixels on the strip
+//! \tparam LED_PIN data pin
+//! \tparam Output the PaletteOutput of the pin or a MultiplexedPaletteOutput
+//! \tparam PALETTE_SIZE number of colors, 2-256
+//! \tparam Scenes SceneList of the palette scenes available, see PaletteScenes.h
+template <uint16_t LED_COUNT,
+          uint8_t LED_PIN,
+          typename Output,
+          uint16_t PALETTE_SIZE = 16,
+          typename Scenes = DefaultPaletteScenes>
+class PaletteRing
+: public RingControl<PaletteRing<LED_COUNT, LED_PIN, Output, PALETTE_SIZE, Scenes>,
+                     typename Output::BackendType,
+                     Scenes,
+                     LED_COUNT,
+                     PaletteRainbowScene,
+                     false>
+{
+    static_assert(LED_COUNT <= Output::led_count, "the output is shorter than the ring");
+    static_assert(Output::multiplexed || Output::led_pin == LED_PIN,
+                  "the output is of another pin, see MultiplexedPaletteOutput");
+
+    using Control = RingControl<PaletteRing,
+                                typename Output::BackendType,
+                                Scenes,
+                                LED_COUNT,
+                                PaletteRainbowScene,
+                                false>;
+    friend Control;
+
+public:
+    using BackendType = typename Output::BackendType;
+    using Strip = typename Output::Strip;
+    using Frame = PaletteFrame<LED_COUNT, PALETTE_SIZE>;
+    using Layers = typename Control::Layers;
+    using Stats = typename Control::Stats;
+
+    static constexpr uint16_t led_count = LED_COUNT;
+    static constexpr uint8_t led_pin = LED_PIN;
+
+    explicit PaletteRing(Output &output) : output(output) {}
+
+    PaletteRing(const PaletteRing &) = delete;
+    PaletteRing &operator=(const PaletteRing &) = delete;
+
+    //! Sets up the output (once for all rings) and turns the strip off, or shows the first frame
+    //! of the state restored (if any).
+    void setup();
+
+    //! Renders and transmits the next frame (if any) of the current scene. Calls without a frame
+    //! flush the log and the state.
+    void process()
+    {
+        const bool emitted = render();
+        flush();
+        if(!emitted)
+            this->idle();
+    }
+
+    //! Renders the next frame (if due) into the frame without transmitting it.
+    //! \return true if a frame is pending for transmission
+    bool render() { return Control::render(scheduler.poll()); }
+
+    using Control::render;
+
+    //! Transmits the pending frame (if any) and waits until the transmission is complete.
+    void flush()
+    {
+        beginFlush();
+        endFlush();
+    }
+
+    //! Transmits the pending frame (if any). Blocks until done since the output may be shared.
+    void beginFlush();
+
+    //! Nothing to wait for, beginFlush() completes the transmission.
+    void endFlush() {}
+
+    // scene interface: used by the scenes to draw into the frame
+
+    //! \return palette and indices of the pixels
+    Frame &getFrame() { return frame; }
+
+private:
+    using Control::frame_counters;
+    using Control::frame_pending;
+    using Control::layers;
+    using Control::restored;
+    using Control::scenes;
+    using Control::scheduler;
+    using Control::stats;
+
+    //! Renders one frame of the active scene, emits it if the layers changed meanwhile.
+    void renderFrame(uint16_t dt_ms);
+
+    //! Scenes are entered at once, there are no transitions.
+    void sceneChanging(bool) {}
+
+    Output &output;
+    Frame frame;
+    //! revision of the layers the frame was transmitted with
+    uint16_t shown_revision{ 0 };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, bool M>
+void BasicPaletteOutput<LC, LP, LT, B, M>::clear(uint8_t pin)
+{
+    select(pin);
+    Pixels::clear(strip.getPixels(), 0, LC);
+
+    StripTransmission<Strip>::begin(strip);
+    StripTransmission<Strip>::end(strip);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, bool M>
+template <typename Frame, typename Layers>
+void BasicPaletteOutput<LC, LP, LT, B, M>::show(const Frame &frame,
+                                                const Layers &layers,
+                                                uint8_t pin)
+{
+    static_assert(Frame::led_count <= LC, "the frame is longer than the output");
+
+    select(pin);
+    frame.template expand<Pixels>(strip.getPixels(), layers);
+    if(Frame::led_count < LC)
+        Pixels::clear(strip.getPixels(), Frame::led_count, LC - Frame::led_count);
+
+    StripTransmission<Strip>::begin(strip);
+    StripTransmission<Strip>::end(strip);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LC, uint8_t LP, typename O, uint16_t PS, typename S>
+void PaletteRing<LC, LP, O, PS, S>::setup()
+{
+    this->template log<LogMessage::Setup>();
+    output.setup(LP);
+    if(!restored)
+    {
+        output.clear(LP);
+        return;
+    }
+
+    // a single transmission of the restored state rather than a blank frame first
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = scheduler.getPeriodMs();
+    render(tick);
+    flush();
+    restored = false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LC, uint8_t LP, typename O, uint16_t PS, typename S>
+void PaletteRing<LC, LP, O, PS, S>::renderFrame(uint16_t dt_ms)
+{
+    const uint32_t skipped = frame_counters.skipped;
+    scenes.render(*this, dt_ms);
+
+    // the layers (i.e. brightness and arc) apply when the frame is expanded, a change of them is
+    // transmitted although the scene kept its frame
+    if(!frame_pending && layers.revision() != shown_revision)
+    {
+        frame_counters.skipped = skipped;
+        this->emitFrame();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <uint16_t LC, uint8_t LP, typename O, uint16_t PS, typename S>
+void PaletteRing<LC, LP, O, PS, S>::beginFlush()
+{
+    if(!frame_pending)
+        return;
+
+    const uint32_t start_us = Stats::enabled ? BackendType::micros() : 0;
+    output.show(frame, layers, LP);
+    if(Stats::enabled)
+        stats.transmitted(BackendType::micros() - start_us);
+    shown_revision = layers.revision();
+    frame_pending = false;
+    ++frame_counters.emitted;
+}
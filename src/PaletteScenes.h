@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+#include "HueTable.h"
+#include "SceneRegistry.h"
+#include "Scenes.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Solid color: all pixels on palette entry 0. Emits a single frame, brightness changes are
+//! transmitted by the ring regardless.
+template <uint8_t R, uint8_t G, uint8_t B> struct PaletteColorScene
+{
+    struct State
+    {
+        bool rendered{ false };
+    };
+
+    static constexpr bool cycled = true;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t)
+    {
+        if(state.rendered)
+        {
+            ring.skipFrame();
+            return;
+        }
+
+        state.rendered = true;
+        ring.getFrame().fill(0);
+        ring.getFrame().setColor(0, Ring::Strip::Color(R, G, B));
+        ring.emitFrame();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Every third pixel lit in the given color, shifted by one pixel each STEP_MS. The pixels refer
+//! to palette entries 0-2, which are recolored each step rather than the pixels being redrawn.
+template <uint8_t R, uint8_t G, uint8_t B, uint16_t STEP_MS = 50> struct PaletteChaseScene
+{
+    struct State
+    {
+        ScenePhase phase;
+        bool indexed{ false };
+    };
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t dt_ms)
+    {
+        typename Ring::Frame &frame = ring.getFrame();
+        if(!state.indexed)
+        {
+            for(uint16_t pixel = 0; pixel < Ring::led_count; pixel++)
+                frame.setIndex(pixel, static_cast<uint8_t>(pixel % 3));
+            state.indexed = true;
+        }
+
+        if(!state.phase.due(STEP_MS))
+        {
+            state.phase.advance(STEP_MS, dt_ms);
+            ring.skipFrame();
+            return;
+        }
+
+        const uint8_t b = static_cast<uint8_t>(state.phase.step(STEP_MS) % 3);
+        state.phase.advance(STEP_MS, dt_ms);
+
+        for(uint8_t entry = 0; entry < 3; entry++)
+            frame.setColor(entry, (entry == b) ? Ring::Strip::Color(R, G, B) : 0);
+        ring.emitFrame();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Color wheel along the strip in PALETTE_SIZE bands, rotating by 256 (of 65536) each STEP_MS.
+//! The pixels keep their band, each step recolors the palette only.
+template <uint16_t STEP_MS = 10> struct PaletteRainbowSceneT
+{
+    struct State
+    {
+        ScenePhase phase;
+        bool indexed{ false };
+    };
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t dt_ms)
+    {
+        using Frame = typename Ring::Frame;
+        Frame &frame = ring.getFrame();
+        if(!state.indexed)
+        {
+            for(uint16_t pixel = 0; pixel < Ring::led_count; pixel++)
+                frame.setIndex(pixel, static_cast<uint8_t>(static_cast<uint32_t>(pixel) *
+                                                           Frame::palette_size / Ring::led_count));
+            state.indexed = true;
+        }
+
+        if(!state.phase.due(STEP_MS))
+        {
+            state.phase.advance(STEP_MS, dt_ms);
+            ring.skipFrame();
+            return;
+        }
+
+        const uint16_t first_hue = static_cast<uint16_t>(state.phase.step(STEP_MS) * 256);
+        state.phase.advance(STEP_MS, dt_ms);
+
+        for(uint16_t entry = 0; entry < Frame::palette_size; entry++)
+        {
+            const uint16_t hue =
+            static_cast<uint16_t>(first_hue + entry * 65536UL / Frame::palette_size);
+            frame.setColor(static_cast<uint8_t>(entry), HueGammaTable::color(hue));
+        }
+        ring.emitFrame();
+    }
+};
+
+using PaletteRainbowScene = PaletteRainbowSceneT<>;
+
+//--------------------------------------------------------------------------------------------------
+
+//! Turns all pixels off at once. Not visited by nextScene().
+struct PaletteOffScene
+{
+    struct State
+    {
+        bool rendered{ false };
+    };
+
+    static constexpr bool cycled = false;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t)
+    {
+        if(state.rendered)
+        {
+            ring.skipFrame();
+            return;
+        }
+
+        state.rendered = true;
+        ring.getFrame().fill(0);
+        ring.getFrame().setColor(0, 0);
+        ring.emitFrame();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+using PaletteWhiteScene = PaletteColorScene<255, 255, 255>;
+using PaletteRedScene = PaletteColorScene<255, 0, 0>;
+using PaletteGreenScene = PaletteColorScene<0, 255, 0>;
+using PaletteBlueScene = PaletteColorScene<0, 0, 255>;
+using PaletteChaseWhiteScene = PaletteChaseScene<127, 127, 127>;
+using PaletteChaseRedScene = PaletteChaseScene<127, 0, 0>;
+using PaletteChaseBlueScene = PaletteChaseScene<0, 0, 127>;
+
+//! All built-in scenes of PaletteRing.
+using DefaultPaletteScenes = SceneList<PaletteWhiteScene,
+                                       PaletteRedScene,
+                                       PaletteGreenScene,
+                                       PaletteBlueScene,
+                                       PaletteChaseWhiteScene,
+                                       PaletteChaseRedScene,
+                                       PaletteChaseBlueScene,
+                                       PaletteRainbowScene,
+                                       PaletteOffScene>;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+// Host fallback: constant data simply lives in (read-only) memory.
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#endif
+
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t *>(addr))
+#endif
+
+#ifndef pgm_read_dword
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+#endif
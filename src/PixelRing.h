@@ -1,16 +1,70 @@
 #pragma once
 
-#include <Adafruit_NeoPixel.h>
-#include <elapsedMillis.h>
-#include "CappedNumber.h"
+#include "CrossFade.h"
+#include "HueTable.h"
+#include "PixelSpan.h"
+#include "RingControl.h"
+#include "Scenes.h"
+#include "StripTransmission.h"
+
+#if defined(ARDUINO)
+#include "NeoPixelBackend.h"
+using DefaultPixelRingBackend = NeoPixelBackend;
+#else
+#include "HostBackend.h"
+using DefaultPixelRingBackend = HostBackend;
+#endif
+
+#ifndef PIXELRING_TRANSITIONS
+//! 0 removes scene transitions along with the RAM of their buffers
+#define PIXELRING_TRANSITIONS 1
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
 
-template <uint16_t LED_COUNT = 16, uint8_t LED_PIN = D0, neoPixelType LED_TYPE = NEO_GRB + NEO_KHZ400>
-class PixelRing
+//! Ring rendering into the strip buffer of Adafruit_NeoPixel. The control (brightness, arc,
+//! scenes, commands, stats, log and state) is that of RingControl.
+//!
+//! \tparam LED_COUNT number of pixels on the strip
+//! \tparam LED_PIN data pin
+//! \tparam LED_TYPE pixel type, see Adafruit_NeoPixel
+//! \tparam Backend provides the Strip, millis(), micros() and log(), see NeoPixelBackend
+//! \tparam Scenes SceneList of the scenes available, see Scenes.h
+template <uint16_t LED_COUNT = 16,
+          uint8_t LED_PIN = D0,
+          neoPixelType LED_TYPE = NEO_GRB + NEO_KHZ400,
+          typename Backend = DefaultPixelRingBackend,
+          typename Scenes = DefaultScenes>
+class PixelRing : public RingControl<PixelRing<LED_COUNT, LED_PIN, LED_TYPE, Backend, Scenes>,
+                                     Backend,
+                                     Scenes,
+                                     LED_COUNT,
+                                     RainbowScene,
+                                     PIXELRING_TRANSITIONS != 0>
 {
+    using Control =
+    RingControl<PixelRing, Backend, Scenes, LED_COUNT, RainbowScene, PIXELRING_TRANSITIONS != 0>;
+    friend Control;
+
 public:
+    using BackendType = Backend;
+    using Strip = typename Backend::Strip;
+    using HueOffsets = HueOffsetTable<LED_COUNT>;
+    using Layers = typename Control::Layers;
+    using Stats = typename Control::Stats;
+    //! layout of the strip buffer, see Strip::getPixels()
+    using Pixels = PixelSpan<LED_TYPE>;
+
+    static constexpr uint16_t led_count = LED_COUNT;
+    static constexpr uint8_t led_pin = LED_PIN;
+    static constexpr neoPixelType led_type = LED_TYPE;
+    static constexpr uint8_t bytes_per_pixel = Pixels::bytes_per_pixel;
+
+    //! Scenes of DefaultScenes in list order; with other scene lists the value is taken as index
+    //! into the list, prefer setScene<Scene>() then. The values are stored and sent as numbers
+    //! (i.e. by StateStore and Command::Kind::SetScene), new scenes are appended after the
+    //! existing ones therefore; None is no scene and always follows the last one.
     enum class SceneMode
     {
         White,
@@ -23,506 +77,342 @@ public:
         TheaterChaseRainbow,
         Rainbow,
         Off,
+        Streaming,
         None // does not touch anything but maintains the previous state
     };
 
+    //! Begins the strip and turns it off, or shows the first frame of the state restored (if any).
     void setup();
 
+    //! Renders and transmits the next frame (if any) of the given scene. Calls without a frame
+    //! flush the log and the state.
+    //! \param scene_mode the scene to switch to, SceneMode::None to resume the current scene
     void process(SceneMode scene_mode = SceneMode::None);
 
-    //! Increments the brightness by maximum +/-20 %
-    //! \param increment percentage to in-/decrement
-    void incrementBrightness(int8_t increment);
-
-    void maxBrightness();
-
-    //! toggles strip on and off
-    //! \return true if strip is toggled on
-    bool toggleOnOff();
-
-    void off();
-
-    void on();
-
-    //! Increments the arc by maximum +/- strip.numPixels()
-    //! \param pixels number of pixels to in-/decrement the arc width
-    void incrementWidth(int8_t pixels);
-
-    void fullWidth();
-
-    //! Shifts (rotates) the arc.
-    //! \param pixels number of pixels to shift for-/backward
-    void shift(int8_t pixels);
-
-    //! Scrolls to the next scene mode: White, Red, ..., Rainbow, White, ... etc.
-    void nextScene();
+    //! Renders the next frame (if due) into the strip buffer without transmitting it.
+    //! \param scene_mode the scene to switch to, SceneMode::None to resume the current scene
+    //! \return true if a frame is pending for transmission
+    bool render(SceneMode scene_mode = SceneMode::None);
 
-private:
-    //! Arc based abstraction of the strip.
-    struct ArcBasedView
-    {
-        ArcBasedView(Adafruit_NeoPixel &strip);
-
-        void process(uint32_t color);
+    using Control::render;
 
-        void process();
+    //! Transmits the pending frame (if any) and waits until the transmission is complete.
+    void flush();
 
-        void rotate(int8_t pixels = 1);
+    //! Starts transmitting the pending frame (if any). Returns immediately on strips supporting
+    //! asynchronous output, blocks until done otherwise. Must be followed by endFlush().
+    void beginFlush();
 
-        void incrementArc(int8_t pixels = 1);
+    //! Waits for the transmission started by beginFlush() to complete.
+    void endFlush();
 
-        void fullWidth();
+    //! Hands the pending frame (if any) over by copying it into the given buffer rather than
+    //! transmitting it, i.e. to the transmit stage of a FramePipeline. The frame observer sees the
+    //! frame and it counts as emitted, the copy counts as its transmission in the stats. The strip
+    //! buffer is kept as rendered.
+    //! \param pixels buffer of LED_COUNT * bytes_per_pixel bytes
+    //! \return false if no frame was pending
+    bool takeFrame(uint8_t *pixels);
 
-    private:
-        void incrementArcByOne(bool do_increment);
+    //! Sets how SceneMode::Off clears the strip.
+    //! \param wait_ms 0 clears all pixels at once, otherwise one pixel is cleared every wait_ms
+    void setWipeInterval(uint16_t wait_ms) { wipe_interval_ms = wait_ms; }
 
-        Adafruit_NeoPixel &strip;
-        uint32_t color{ 0 };
-
-        CappedNumber<LED_COUNT> begin;
-        CappedNumber<LED_COUNT> end;
-        CappedNumber<LED_COUNT> pixel_iterator;
-        //! toggle bit to ensures alternate access (left, right)
-        uint8_t toggle : 1;
-        uint8_t _stuff : 7;
-    };
+    uint16_t getWipeInterval() const { return wipe_interval_ms; }
 
-    uint8_t overrideColorChannelBrightness(uint8_t color);
+    //! Sets how long scene changes crossfade from the scene left to the scene entered. Both scenes
+    //! keep animating during the transition. Ignored if PIXELRING_TRANSITIONS is 0.
+    //! \param duration_ms 0 switches scenes at once
+    void setTransitionDuration(uint16_t duration_ms) { transition_ms = duration_ms; }
 
-    uint32_t overrideColorBrightness(uint32_t color);
+    uint16_t getTransitionDuration() const { return transition_ms; }
 
-    //! Puts the given color on the whole strip wrt. to the current brightness.
-    //! \param color the color on strip
-    void colorWipe(uint32_t color);
+    //! \return true while crossfading between two scenes
+    bool isTransitioning() const { return transition_active; }
 
-    void theaterChase(uint32_t color, uint16_t wait_ms);
-
-    void rainbow(uint16_t wait_ms);
-
-    void theaterChaseRainbow(uint16_t wait_ms);
-
-    using Strip = Adafruit_NeoPixel;
-    Strip strip{ LED_COUNT, LED_PIN, LED_TYPE };
+    //! \return the underlying strip, i.e. to inspect the frame log of a simulated strip
+    Strip &getStrip() { return strip; }
 
-    //! 0-100 [%]
-    uint8_t brightness{ 100 };
-    //! 0-1 (on, off)
-    uint8_t brightness_override{ 1 };
+    //! Called with each frame right before it is transmitted.
+    //! \param context passed through to the observer
+    using FrameObserver =
+    void (*)(void *context, const uint8_t *pixels, uint16_t size, uint32_t time_ms);
 
-    SceneMode last_scene_mode = { SceneMode::Rainbow };
-    //! timer to measure elapsed time in [ms] since set to 0
-    elapsedMillis time_elapsed{ 0 };
-
-    //! arc based abstraction of the strip
-    ArcBasedView arc_view{ strip };
-};
-
-
-// -----------------------------------------------------------r--------------------------------------
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::setup()
-{
-    Serial.println("PixelRing::setup");
-    strip.begin();
-    strip.show();
-}
-
-// -------------------------------------------------------------------------------------------------
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::process(PixelRing::SceneMode scene_mode)
-{
-    last_scene_mode = (scene_mode == SceneMode::None) ? last_scene_mode : scene_mode;
-    switch(last_scene_mode)
+    //! Sets the function observing the frames transmitted, i.e. FrameRecorder::observe().
+    //! \param observer nullptr removes the observer
+    void setFrameObserver(FrameObserver observer, void *context)
     {
-    case SceneMode::Off:
-        colorWipe(Strip::Color(0, 0, 0));
-        break;
-    case SceneMode::Red:
-        arc_view.process(overrideColorBrightness(Strip::Color(255, 0, 0)));
-        break;
-    case SceneMode::Green:
-        arc_view.process(overrideColorBrightness(Strip::Color(0, 255, 0)));
-        break;
-    case SceneMode::Blue:
-        arc_view.process(overrideColorBrightness(Strip::Color(0, 0, 255)));
-        break;
-    case SceneMode::White:
-        arc_view.process(overrideColorBrightness(Strip::Color(255, 255, 255)));
-        break;
-    case SceneMode::TheaterChaseWhite:
-        theaterChase(overrideColorBrightness(Strip::Color(127, 127, 127)), 50);
-        break;
-    case SceneMode::TheaterChaseRed:
-        theaterChase(overrideColorBrightness(Strip::Color(127, 0, 0)), 50);
-        break;
-    case SceneMode::TheaterChaseBlue:
-        theaterChase(overrideColorBrightness(Strip::Color(0, 0, 127)), 50);
-        break;
-    case SceneMode::Rainbow:
-        rainbow(10);
-        break;
-    case SceneMode::TheaterChaseRainbow:
-        theaterChaseRainbow(50);
-        break;
-    case SceneMode::None:
-        break;
+        frame_observer = observer;
+        frame_observer_context = context;
     }
-}
-
-
-// -------------------------------------------------------------------------------------------------
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::incrementBrightness(int8_t increment)
-{
-    const int8_t max_step = 20;
-    auto cap = [](int8_t &value, int8_t min, int8_t max) {
-        value = (value > max) ? max : value;
-        value = (value < min) ? min : value;
-        return value;
-    };
-
-    cap(increment, -max_step, max_step);
-
-    int8_t new_brightness = brightness;
-    new_brightness += increment;
-    cap(new_brightness, 5, 100);
-
-    brightness = static_cast<uint8_t>(new_brightness);
-    Serial.print("PixelRing::incrementBrightness: ");
-    Serial.println(brightness);
-}
-
-// -------------------------------------------------------------------------------------------------
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::maxBrightness()
-{
-    brightness = 100;
-}
 
-// -------------------------------------------------------------------------------------------------
+    //! Fills the strip buffer with the pixels received, scaled by the brightness scale 0-256.
+    //! \return true if a frame was completed
+    using PixelInput = bool (*)(void *context, uint8_t *pixels, uint16_t scale);
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-uint8_t PixelRing<LC, LP, LT>::overrideColorChannelBrightness(uint8_t color_value)
-{
-    uint16_t color =
-    ((uint16_t)brightness_override * (uint16_t)brightness * (uint16_t)color_value) / (uint16_t)100;
-    color = color > 255 ? 255 : color;
-    return static_cast<uint8_t>(color);
-}
-
-// -------------------------------------------------------------------------------------------------
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-uint32_t PixelRing<LC, LP, LT>::overrideColorBrightness(uint32_t color)
-{
-    uint8_t r = static_cast<uint8_t>((color & 0x00ff0000) >> 16);
-    uint8_t g = static_cast<uint8_t>((color & 0x0000ff00) >> 8);
-    uint8_t b = static_cast<uint8_t>((color & 0x000000ff));
-
-    return Strip::Color(overrideColorChannelBrightness(r), overrideColorChannelBrightness(g),
-                        overrideColorChannelBrightness(b));
-}
+    //! Sets where StreamScene takes its pixels from, i.e. AdalightInput::receive().
+    //! \param input nullptr removes the input
+    void setPixelInput(PixelInput input, void *context)
+    {
+        pixel_input = input;
+        pixel_input_context = context;
+    }
 
-// -------------------------------------------------------------------------------------------------
+    // scene interface: used by the scenes to draw into the strip
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::colorWipe(uint32_t color)
-{
-    for(uint16_t i = 0; i < strip.numPixels(); i++)
+    //! Composites the layers over the scene given by the shader into the strip buffer, wrt. to the
+    //! current brightness. Pixels are written in wire byte order as of LED_TYPE.
+    //! \param shader provides the scene color of a pixel: uint32_t shader(uint16_t pixel)
+    template <typename Shader> void compose(const Shader &shader)
     {
-        strip.setPixelColor(i, color);
-        strip.show();
+        layers.template composePixels<Pixels>(strip.getPixels(), shader);
     }
-}
 
-// -------------------------------------------------------------------------------------------------
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::theaterChase(uint32_t color, uint16_t wait_ms)
-{
-    if(time_elapsed < wait_ms)
-        return;
-    time_elapsed = 0;
+    //! Composites the layers over a scene of a single color, filling the strip buffer span by
+    //! span rather than pixel by pixel.
+    void composeColor(uint32_t color)
+    {
+        layers.template composeColor<Pixels>(strip.getPixels(), color);
+    }
 
-    static uint16_t a = 0, a_max = 10; // outer loop
-    static uint16_t b = 0, b_max = 3;  // inner loop
+    //! Receives pixels from the pixel input (if any) into the strip buffer, bypassing the layers.
+    //! \return true if a frame was completed
+    bool receivePixels()
+    {
+        return pixel_input && pixel_input(pixel_input_context, strip.getPixels(), brightness_scale);
+    }
 
+    //! \return the color wrt. to the current brightness
+    uint32_t overrideColorBrightness(uint32_t color)
     {
-        strip.clear(); //   Set all pixels in RAM to 0 (off)
-        // 'c' counts up from 'b' to end of strip in steps of 3...
-        for(uint16_t c = b; c < strip.numPixels(); c += 3)
-        {
-            strip.setPixelColor(c, color); // Set pixel 'c' to value 'color'
-        }
-        strip.show(); // Update strip with new contents
+        return BrightnessScale::apply(color, brightness_scale);
     }
 
-    b++;
-    if(b >= b_max)
+    //! Applies the current brightness to the whole strip buffer.
+    void overrideBufferBrightness()
     {
-        a++;
-        b = 0;
+        BrightnessScale::apply(strip.getPixels(), LED_COUNT * bytes_per_pixel, brightness_scale);
     }
 
-    if(a >= a_max)
-        a = 0;
-}
+private:
+    using Control::brightness_scale;
+    using Control::frame_counters;
+    using Control::frame_pending;
+    using Control::layers;
+    using Control::restored;
+    using Control::scenes;
+    using Control::scheduler;
+    using Control::stats;
 
-// -------------------------------------------------------------------------------------------------
+    //! Renders one frame of the active scene, or of both scenes while transitioning.
+    void renderFrame(uint16_t dt_ms);
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::rainbow(uint16_t wait_ms)
-{
-    if(time_elapsed < wait_ms)
-        return;
-    time_elapsed = 0;
+    //! Begins a transition to the scene entered unless at once.
+    void sceneChanging(bool at_once);
 
-    // Hue of first pixel runs 3 complete loops through the color wheel.
-    // Color wheel has a range of 65536 but it's OK if we roll over, so
-    // just count from 0 to 3*65536. Adding 256 to firstPixelHue each time
-    // means we'll make 3*65536/256 = 768 passes through this outer process:
-    static uint32_t firstPixelHue = 0, firstPixelHue_max = 3 * 65536;
+    //! Takes the strip buffer as starting point of a transition to the scene entered next.
+    void beginTransition();
 
-    {
-        for(uint16_t i = 0; i < strip.numPixels(); i++)
-        {
-            // For each pixel in strip...
-            // Offset pixel hue by an amount to make one full revolution of the
-            // color wheel (range of 65536) along the length of the strip
-            // (strip.numPixels() steps):
-            uint16_t pixelHue = static_cast<uint16_t>(firstPixelHue + (i * 65536L / strip.numPixels()));
-            // strip.ColorHSV() can take 1 or 3 arguments: a hue (0 to 65535) or
-            // optionally add saturation and value (brightness) (each 0 to 255).
-            // Here we're using just the single-argument hue variant. The result
-            // is passed through strip.gamma32() to provide 'truer' colors
-            // before assigning to each pixel:
-            uint32_t color = overrideColorBrightness(Strip::gamma32(Strip::ColorHSV(pixelHue)));
-            strip.setPixelColor(i, color);
-        }
-        strip.show(); // Update strip with new contents
-        // delay(wait);  // Pause for a moment
-    }
+    //! Renders one frame of both scenes, each into its own buffer, and blends them into the strip.
+    void renderTransition(uint16_t dt_ms);
 
-    firstPixelHue += 256;
-    if(firstPixelHue > firstPixelHue_max)
-        firstPixelHue = 0;
-}
+    Strip strip{ LED_COUNT, LED_PIN, LED_TYPE };
 
-// -------------------------------------------------------------------------------------------------
+    FrameObserver frame_observer{ nullptr };
+    void *frame_observer_context{ nullptr };
+    PixelInput pixel_input{ nullptr };
+    void *pixel_input_context{ nullptr };
+    //! transmission begun but not ended yet
+    bool transmitting{ false };
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::theaterChaseRainbow(uint16_t wait_ms)
-{
-    if(time_elapsed < wait_ms)
-        return;
-    time_elapsed = 0;
+    uint16_t wipe_interval_ms{ 0 };
 
-    static uint16_t a = 0, a_max = 30; // outer loop
-    static uint16_t b = 0, b_max = 3;  // inner loop
+    //! scene buffers while transitioning
+    CrossFadeBuffers<PIXELRING_TRANSITIONS ? LED_COUNT * bytes_per_pixel : 0> fade;
+    uint16_t transition_ms{ 0 };
+    uint16_t transition_elapsed_ms{ 0 };
+    bool transition_active{ false };
+};
 
-    {
-        static uint16_t firstPixelHue = 0; // First pixel starts at red (hue 0)
-        strip.clear();                     //   Set all pixels in RAM to 0 (off)
-        // 'c' counts up from 'b' to end of strip in increments of 3...
-        for(uint16_t c = b; c < strip.numPixels(); c += 3)
-        {
-            // hue of pixel 'c' is offset by an amount to make one full
-            // revolution of the color wheel (range 65536) along the length
-            // of the strip (strip.numPixels() steps):
-            uint16_t hue = static_cast<uint16_t>(firstPixelHue + c * 65536 / strip.numPixels());
-            uint32_t color = overrideColorBrightness(Strip::gamma32(Strip::ColorHSV(hue))); // hue -> RGB
-            strip.setPixelColor(c, color); // Set pixel 'c' to value 'color'
-        }
-        strip.show();                // Update strip with new contents
-        firstPixelHue += 65536 / 90; // One cycle of color wheel over 90 frames
-    }
 
-    b++;
-    if(b >= b_max)
+// -----------------------------------------------------------r--------------------------------------
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::setup()
+{
+    this->template log<LogMessage::Setup>();
+    strip.begin();
+    if(!restored)
     {
-        a++;
-        b = 0;
+        strip.show();
+        return;
     }
 
-    if(a >= a_max)
-        a = 0;
+    // a single transmission of the restored state rather than a blank frame first
+    FrameTick tick;
+    tick.frames = 1;
+    tick.period_ms = scheduler.getPeriodMs();
+    render(tick);
+    flush();
+    restored = false;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT> bool PixelRing<LC, LP, LT>::toggleOnOff()
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::process(PixelRing::SceneMode scene_mode)
 {
-    if(brightness_override == 1)
-    {
-        off();
-    }
-    else
-    {
-        on();
-        return true;
-    }
-    return false;
+    const bool emitted = render(scene_mode);
+    flush();
+    if(!emitted)
+        this->idle();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::off()
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+bool PixelRing<LC, LP, LT, B, S>::render(PixelRing::SceneMode scene_mode)
 {
-    brightness_override = 0;
-    Serial.println("PixelRing::off: turning off");
-}
-
-// -------------------------------------------------------------------------------------------------
+    if(scene_mode != SceneMode::None)
+        this->setScene(static_cast<uint8_t>(scene_mode));
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::on()
-{
-    brightness_override = 1;
-    Serial.println("PixelRing::on: turning on");
+    return Control::render(scheduler.poll());
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::incrementWidth(int8_t pixels)
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::renderFrame(uint16_t dt_ms)
 {
-    arc_view.incrementArc(pixels);
+    if(decltype(fade)::enabled && transition_active)
+        renderTransition(dt_ms);
+    else
+        scenes.render(*this, dt_ms);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::fullWidth()
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::flush()
 {
-    arc_view.fullWidth();
+    beginFlush();
+    endFlush();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::shift(int8_t pixels)
-{
-    arc_view.rotate(pixels);
-}
-
-// -------------------------------------------------------------------------------------------------
-template <uint16_t LC, uint8_t LP, neoPixelType LT> void PixelRing<LC, LP, LT>::nextScene()
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::beginFlush()
 {
-    auto next = [&]() {
-        return static_cast<PixelRing<LC, LP, LT>::SceneMode>(static_cast<uint8_t>(last_scene_mode) + 1);
-    };
+    if(!frame_pending)
+        return;
 
-    last_scene_mode = next();
-    if(last_scene_mode == SceneMode::Off)
-        last_scene_mode = next();
+    if(frame_observer)
+    {
+        frame_observer(frame_observer_context, strip.getPixels(), LC * bytes_per_pixel,
+                       B::millis());
+    }
 
-    if(last_scene_mode == SceneMode::None || last_scene_mode == SceneMode::Off)
-        last_scene_mode = SceneMode::White;
+    const uint32_t start_us = Stats::enabled ? B::micros() : 0;
+    StripTransmission<Strip>::begin(strip);
+    if(Stats::enabled)
+        stats.transmitting(B::micros() - start_us);
+    frame_pending = false;
+    transmitting = true;
+    ++frame_counters.emitted;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-PixelRing<LC, LP, LT>::ArcBasedView::ArcBasedView(Adafruit_NeoPixel &strip)
-: strip(strip), begin(0), end(LC - 1), pixel_iterator(0), toggle(0)
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+bool PixelRing<LC, LP, LT, B, S>::takeFrame(uint8_t *pixels)
 {
-}
+    if(!frame_pending)
+        return false;
 
-// -------------------------------------------------------------------------------------------------
+    if(frame_observer)
+    {
+        frame_observer(frame_observer_context, strip.getPixels(), LC * bytes_per_pixel,
+                       B::millis());
+    }
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::ArcBasedView::process(uint32_t new_color)
-{
-    this->color = new_color;
-    process();
+    // the copy is what the ring spends on transmitting a frame handed over
+    const uint32_t start_us = Stats::enabled ? B::micros() : 0;
+    memcpy(pixels, strip.getPixels(), LC * bytes_per_pixel);
+    if(Stats::enabled)
+        stats.transmitted(B::micros() - start_us);
+    frame_pending = false;
+    ++frame_counters.emitted;
+    return true;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::ArcBasedView::process()
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::endFlush()
 {
-    uint32_t *color_ptr = &color;
-    uint32_t black = Strip::Color(0, 0, 0);
-
-    pixel_iterator = begin;
-    do
-    {
-        strip.setPixelColor(pixel_iterator, *color_ptr);
-
-        if(pixel_iterator == end)
-            color_ptr = &black;
-    } while(++pixel_iterator != begin);
+    if(!transmitting)
+        return;
 
-    strip.show();
+    const uint32_t start_us = Stats::enabled ? B::micros() : 0;
+    StripTransmission<Strip>::end(strip);
+    if(Stats::enabled)
+        stats.transmitted(B::micros() - start_us);
+    transmitting = false;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::ArcBasedView::rotate(int8_t pixels)
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::sceneChanging(bool at_once)
 {
-    begin += pixels;
-    end += pixels;
+    if(at_once)
+        transition_active = false;
+    else if(decltype(fade)::enabled && transition_ms > 0)
+        beginTransition();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::ArcBasedView::incrementArc(int8_t pixels)
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::beginTransition()
 {
-    Serial.print("PixelRing::ArcBasedView::incrementArc: ");
-    Serial.println(pixels);
-
-    while(pixels < 0)
-    {
-        incrementArcByOne(false);
-        ++pixels;
-    }
-
-    while(pixels > 0)
-    {
-        incrementArcByOne(true);
-        --pixels;
-    }
+    const uint16_t size = LC * bytes_per_pixel;
+
+    // the scene left continues on the buffer it rendered into, which is the strip buffer unless
+    // it was entered by a transition itself; the scene entered starts off what is shown
+    memcpy(fade.from, transition_active ? fade.to : strip.getPixels(), size);
+    memcpy(fade.to, strip.getPixels(), size);
+    transition_elapsed_ms = 0;
+    transition_active = true;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::ArcBasedView::incrementArcByOne(bool do_increment)
+template <uint16_t LC, uint8_t LP, neoPixelType LT, typename B, typename S>
+void PixelRing<LC, LP, LT, B, S>::renderTransition(uint16_t dt_ms)
 {
-    int8_t increment = do_increment ? 1 : -1;
-
-    // disallow underflow
-    if(!do_increment && begin == end)
-        return;
-
-    uint16_t previous_begin = begin, previous_end = end;
-
-    // do the increment
-    if(toggle++ == 0)
-    {
-        begin -= increment;
-    }
-    else
-    {
-        end += increment;
-    }
-
-    // revert on overflow
-    if(do_increment && begin == end)
-    {
-        end = previous_end;
-        begin = previous_begin;
-    }
+    const uint16_t size = LC * bytes_per_pixel;
+    uint8_t *pixels = strip.getPixels();
+    // frames skipped by either scene are irrelevant, the blend changes each frame
+    const uint32_t skipped = frame_counters.skipped;
+
+    // each scene renders as if it had the strip buffer to itself
+    memcpy(pixels, fade.to, size);
+    scenes.render(*this, dt_ms);
+    memcpy(fade.to, pixels, size);
+
+    memcpy(pixels, fade.from, size);
+    scenes.renderPrevious(*this, dt_ms);
+    memcpy(fade.from, pixels, size);
+
+    transition_elapsed_ms = (transition_ms - transition_elapsed_ms > dt_ms) ?
+                            static_cast<uint16_t>(transition_elapsed_ms + dt_ms) :
+                            transition_ms;
+    CrossFade::blend(pixels, fade.from, fade.to, size,
+                     CrossFade::weight(transition_elapsed_ms, transition_ms));
+
+    frame_counters.skipped = skipped;
+    transition_active = transition_elapsed_ms < transition_ms;
+    this->emitFrame();
 }
 
-// -------------------------------------------------------------------------------------------------
-
-template <uint16_t LC, uint8_t LP, neoPixelType LT>
-void PixelRing<LC, LP, LT>::ArcBasedView::fullWidth()
-{
-    begin = 0;
-    end = 0;
-    --end;
-}
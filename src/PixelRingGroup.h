@@ -0,0 +1,143 @@
+#pragma once
+
+#include <tuple>
+#include "FrameScheduler.h"
+#include "IndexSequence.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Drives several PixelRing instances (of possibly different types) from one process() call and
+//! one shared FrameScheduler. All rings are rendered first and transmitted afterwards. Rings on
+//! strips with asynchronous output (see StripTransmission) are put on the wire in parallel.
+//!
+//!     PixelRing<24, D1> left;
+//!     PixelRing<60, D2> right;
+//!     PixelRingGroup<PixelRing<24, D1>, PixelRing<60, D2>> group{ left, right };
+//!
+//! \tparam Rings PixelRing types
+template <typename... Rings> class PixelRingGroup
+{
+public:
+    using Backend = typename std::tuple_element<0, std::tuple<Rings...>>::type::BackendType;
+
+    struct FrameTime
+    {
+        //! number of process() calls with frames due
+        uint32_t ticks{ 0 };
+        //! number of ticks which transmitted at least one ring
+        uint32_t frames{ 0 };
+        //! duration of rendering all rings within the last process() in [us]
+        uint32_t last_render_us{ 0 };
+        //! duration of transmitting all rings within the last process() in [us]
+        uint32_t last_transmit_us{ 0 };
+        //! longest process() in [us]
+        uint32_t max_frame_us{ 0 };
+        //! sum of all process() durations in [us]
+        uint64_t total_frame_us{ 0 };
+
+        uint32_t meanFrameUs() const
+        {
+            return ticks ? static_cast<uint32_t>(total_frame_us / ticks) : 0;
+        }
+    };
+
+    PixelRingGroup(Rings &... rings) : rings(rings...) {}
+
+    void setup() { forEach(Setup{}); }
+
+    //! Renders the next frame (if due) of all rings, then transmits all pending frames. Calls
+    //! without a frame let all rings idle, see RingControl::idle().
+    void process();
+
+    //! \return the scheduler pacing all rings of the group
+    FrameScheduler<Backend> &getScheduler() { return scheduler; }
+
+    const FrameTime &getFrameTime() const { return frame_time; }
+
+    void resetFrameTime() { frame_time = FrameTime{}; }
+
+    static constexpr uint16_t size() { return sizeof...(Rings); }
+
+private:
+    struct Setup
+    {
+        template <typename Ring> void operator()(Ring &ring) { ring.setup(); }
+    };
+
+    struct Render
+    {
+        template <typename Ring> void operator()(Ring &ring)
+        {
+            pending += ring.render(tick) ? 1 : 0;
+        }
+        const FrameTick &tick;
+        uint16_t pending;
+    };
+
+    struct BeginFlush
+    {
+        template <typename Ring> void operator()(Ring &ring) { ring.beginFlush(); }
+    };
+
+    struct EndFlush
+    {
+        template <typename Ring> void operator()(Ring &ring) { ring.endFlush(); }
+    };
+
+    struct Idle
+    {
+        template <typename Ring> void operator()(Ring &ring) { ring.idle(); }
+    };
+
+    template <typename F> F forEach(F f)
+    {
+        return forEach(f, typename MakeIndexSequence<sizeof...(Rings)>::type{});
+    }
+
+    template <typename F, uint16_t... I> F forEach(F f, IndexSequence<I...>)
+    {
+        // braced initializer lists are evaluated in order
+        using swallow = int[];
+        (void)swallow{ 0, (f(std::get<I>(rings)), 0)... };
+        return f;
+    }
+
+    std::tuple<Rings &...> rings;
+    FrameScheduler<Backend> scheduler;
+    FrameTime frame_time;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename... Rings> void PixelRingGroup<Rings...>::process()
+{
+    const FrameTick tick = scheduler.poll();
+    if(tick.frames == 0)
+    {
+        forEach(Idle{});
+        return;
+    }
+
+    const uint32_t start_us = Backend::micros();
+    const uint16_t pending = forEach(Render{ tick, 0 }).pending;
+    const uint32_t rendered_us = Backend::micros();
+
+    if(pending > 0)
+    {
+        forEach(BeginFlush{});
+        forEach(EndFlush{});
+        ++frame_time.frames;
+    }
+    const uint32_t end_us = Backend::micros();
+
+    frame_time.last_render_us = rendered_us - start_us;
+    frame_time.last_transmit_us = end_us - rendered_us;
+    frame_time.max_frame_us =
+    (end_us - start_us > frame_time.max_frame_us) ? end_us - start_us : frame_time.max_frame_us;
+    frame_time.total_frame_us += end_us - start_us;
+    ++frame_time.ticks;
+
+    // after the frame time, idling is no part of it
+    if(pending == 0)
+        forEach(Idle{});
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Writes pixels straight into a strip buffer in wire byte order, i.e. into Strip::getPixels().
+//! The channel order is resolved at compile time from the pixel type. Unlike
+//! Adafruit_NeoPixel::setPixelColor() no brightness is applied, PixelRing scales colors itself and
+//! leaves the brightness of the strip at its default.
+//!
+//! \tparam LED_TYPE pixel type, see Adafruit_NeoPixel
+template <uint16_t LED_TYPE> struct PixelSpan
+{
+    static constexpr uint8_t white_offset = (LED_TYPE >> 6) & 0x03;
+    static constexpr uint8_t red_offset = (LED_TYPE >> 4) & 0x03;
+    static constexpr uint8_t green_offset = (LED_TYPE >> 2) & 0x03;
+    static constexpr uint8_t blue_offset = LED_TYPE & 0x03;
+    static constexpr uint8_t bytes_per_pixel = (white_offset == red_offset) ? 3 : 4;
+
+    //! Writes a packed 0xWWRRGGBB color into one pixel.
+    static void encode(uint32_t color, uint8_t *pixel)
+    {
+        pixel[red_offset] = static_cast<uint8_t>(color >> 16);
+        pixel[green_offset] = static_cast<uint8_t>(color >> 8);
+        pixel[blue_offset] = static_cast<uint8_t>(color);
+        if(bytes_per_pixel == 4)
+            pixel[white_offset] = static_cast<uint8_t>(color >> 24);
+    }
+
+    //! Fills count pixels from begin on with the color. The first pixel is encoded, the others are
+    //! copied from the pixels filled already, doubling the chunk each time.
+    static void fill(uint8_t *pixels, uint32_t color, uint16_t begin, uint16_t count)
+    {
+        if(count == 0)
+            return;
+
+        uint8_t *first = &pixels[begin * bytes_per_pixel];
+        const uint32_t size = static_cast<uint32_t>(count) * bytes_per_pixel;
+        if(uniform(color))
+        {
+            memset(first, static_cast<uint8_t>(color), size);
+            return;
+        }
+
+        encode(color, first);
+        for(uint32_t filled = bytes_per_pixel; filled < size;)
+        {
+            const uint32_t chunk = (filled < size - filled) ? filled : size - filled;
+            memcpy(first + filled, first, chunk);
+            filled += chunk;
+        }
+    }
+
+    //! Turns count pixels from begin on off.
+    static void clear(uint8_t *pixels, uint16_t begin, uint16_t count)
+    {
+        memset(&pixels[begin * bytes_per_pixel], 0, static_cast<uint32_t>(count) * bytes_per_pixel);
+    }
+
+private:
+    //! \return true if all bytes of the color in wire order are the same, i.e. off or gray
+    static bool uniform(uint32_t color)
+    {
+        const uint32_t mask = (bytes_per_pixel == 4) ? 0xffffffff : 0x00ffffff;
+        return ((color ^ (color >> 8)) & (mask >> 8)) == 0;
+    }
+};
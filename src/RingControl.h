@@ -0,0 +1,811 @@
+#pragma once
+
+#include "BrightnessScale.h"
+#include "CappedNumber.h"
+#include "CommandQueue.h"
+#include "Compositor.h"
+#include "EventLog.h"
+#include "FrameScheduler.h"
+#include "FrameStats.h"
+#include "SceneRegistry.h"
+#include "StateStore.h"
+
+#ifndef PIXELRING_INSTRUMENTATION
+//! 0 removes the frame timing and counters of getStats() along with their RAM
+#define PIXELRING_INSTRUMENTATION 1
+#endif
+
+#ifndef PIXELRING_LOG_LEVEL
+//! messages above are compiled out: 0 none (removes the log buffer), 1 errors, 2 warnings, 3 info,
+//! 4 debug, see LogLevel
+#define PIXELRING_LOG_LEVEL 3
+#endif
+
+#ifndef PIXELRING_LOG_CAPACITY
+//! number of log entries buffered until flushed, a power of two
+#define PIXELRING_LOG_CAPACITY 16
+#endif
+
+#ifndef PIXELRING_COMMAND_QUEUE
+//! capacity of the queue of post(), a power of two; 0 removes the queue along with its RAM
+#define PIXELRING_COMMAND_QUEUE 16
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+//! Control of a ring regardless of where its frames are kept: brightness and on/off, the arc and
+//! further layers, the active scene, the command queue, stats, log and the state kept across a
+//! reset. Base of PixelRing and PaletteRing, which keep and transmit the frames. The ring derives
+//! as Ring and provides to its base
+//!
+//!     //! renders one frame of the active scene
+//!     void renderFrame(uint16_t dt_ms);
+//!     //! called right before a scene is entered, at_once if without a transition (i.e. restored)
+//!     void sceneChanging(bool at_once);
+//!
+//! \tparam Ring the ring deriving, passed to the scenes
+//! \tparam Backend provides millis(), micros() and log(), see NeoPixelBackend
+//! \tparam Scenes SceneList of the scenes available
+//! \tparam LED_COUNT number of pixels on the strip
+//! \tparam FirstScene scene active at first if in the scene list, the first scene otherwise
+//! \tparam TRANSITIONS whether the ring renders the scene left during a transition, which keeps a
+//! copy of its state
+template <typename Ring,
+          typename Backend,
+          typename Scenes,
+          uint16_t LED_COUNT,
+          typename FirstScene,
+          bool TRANSITIONS>
+class RingControl
+{
+protected:
+    using SceneTable = SceneRegistry<Ring, Scenes, LED_COUNT, TRANSITIONS>;
+
+public:
+    using Layers = Compositor<LED_COUNT>;
+
+    //! Control input posted from other threads, tasks or ISRs, see post().
+    struct Command
+    {
+        enum class Kind : uint8_t
+        {
+            //! incrementBrightness(value)
+            Brightness,
+            MaxBrightness,
+            ToggleOnOff,
+            On,
+            Off,
+            //! incrementWidth(value)
+            Width,
+            FullWidth,
+            //! shift(value)
+            Shift,
+            NextScene,
+            RestartScene,
+            //! setScene(value)
+            SetScene
+        };
+
+        Kind kind;
+        int16_t value;
+    };
+
+    //! Renders the given frames of the current scene regardless of the ring's own scheduler,
+    //! i.e. if driven by an external timebase.
+    //! \return true if a frame is pending for transmission
+    bool render(const FrameTick &tick);
+
+    //! Does what a call without a frame has time for: flushes the log and the state and dumps the
+    //! stats if due. Called by process() when idle, to be called when idle if the ring is driven
+    //! otherwise, i.e. by FramePipeline.
+    void idle();
+
+    //! Increments the brightness by maximum +/-20 %
+    //! \param increment percentage to in-/decrement
+    void incrementBrightness(int8_t increment);
+
+    void maxBrightness();
+
+    //! Sets the brightness, i.e. for a timeline. Unlike incrementBrightness() it is not logged.
+    //! \param percent 5-100 [%], clamped
+    void setBrightness(uint8_t percent);
+
+    //! \return brightness 5-100 [%], regardless of on and off
+    uint8_t getBrightness() const { return brightness; }
+
+    //! toggles strip on and off
+    //! \return true if strip is toggled on
+    bool toggleOnOff();
+
+    bool isOn() const { return brightness_override != 0; }
+
+    void off();
+
+    void on();
+
+    //! Increments the arc, which masks all scenes, by maximum +/- strip.numPixels()
+    //! \param pixels number of pixels to in-/decrement the arc width
+    void incrementWidth(int8_t pixels);
+
+    void fullWidth();
+
+    //! Shifts (rotates) the arc.
+    //! \param pixels number of pixels to shift for-/backward
+    void shift(int8_t pixels);
+
+    //! Sets the arc, i.e. for a timeline.
+    //! \param begin first pixel of the arc, taken modulo strip.numPixels()
+    //! \param width number of pixels of the arc, 1-strip.numPixels(), clamped
+    void setArc(uint16_t begin, uint16_t width);
+
+    //! Scrolls to the next scene mode: White, Red, ..., Rainbow, White, ... etc.
+    //! Scenes not cycled (i.e. Off) are skipped.
+    void nextScene();
+
+    //! Restarts the animation of the current scene from its very first frame.
+    void restartScene();
+
+    //! Switches to the given scene unless it is active already.
+    //! \param index position of the scene in the scene list, ignored if beyond
+    void setScene(uint8_t index);
+
+    template <typename Scene> void setScene()
+    {
+        static_assert(SceneTable::template indexOf<Scene>() < SceneTable::size,
+                      "scene is not in the scene list");
+        setScene(SceneTable::template indexOf<Scene>());
+    }
+
+    //! \return position of the active scene in the scene list
+    uint8_t getScene() const { return scenes.current(); }
+
+    //! Queues a control command to be applied at the next frame boundary by render(). Unlike the
+    //! control methods above this is safe to call from other threads, tasks and ISRs. Commands
+    //! posted in between two frames are coalesced, i.e. ten brightness steps change the brightness
+    //! scale once and several scene changes enter the last scene only.
+    //! \return false if the queue is full or PIXELRING_COMMAND_QUEUE is 0
+    bool post(typename Command::Kind kind, int16_t value = 0)
+    {
+        return commands.push({ kind, value });
+    }
+
+    //! Sets how long brightness changes (including on() and off()) are eased over.
+    //! \param duration_ms time to fade from off to full brightness, 0 changes at once
+    void setBrightnessEasing(uint16_t duration_ms) { brightness_easing_ms = duration_ms; }
+
+    uint16_t getBrightnessEasing() const { return brightness_easing_ms; }
+
+    //! \return the scheduler to configure the frame rate or to query the actual frame rate
+    FrameScheduler<Backend> &getScheduler() { return scheduler; }
+
+    //! \return the layers composited over all scenes, i.e. to add overlays, masks or further arcs.
+    //! The arc maintained by incrementWidth(), fullWidth() and shift() is the first arc layer.
+    Layers &getLayers() { return layers; }
+
+    struct FrameCounters
+    {
+        //! frames transmitted (or handed over for transmission)
+        uint32_t emitted{ 0 };
+        //! frames due but not transmitted since identical to the previous one
+        uint32_t skipped{ 0 };
+    };
+
+    const FrameCounters &getFrameCounters() const { return frame_counters; }
+
+    void resetFrameCounters() { frame_counters = FrameCounters{}; }
+
+    using Stats = FrameStats<SceneTable::size, PIXELRING_INSTRUMENTATION != 0>;
+
+    //! \return render and transmit timing and frame counters per scene, empty if
+    //! PIXELRING_INSTRUMENTATION is 0
+    const Stats &getStats() const { return stats; }
+
+    void resetStats() { stats.reset(); }
+
+    //! Makes idle() dump the stats to the log periodically.
+    //! \param interval_ms 0 disables dumping
+    void setStatsInterval(uint32_t interval_ms) { stats_interval_ms = interval_ms; }
+
+    using LogBuffer = EventLog<PIXELRING_LOG_CAPACITY, PIXELRING_LOG_LEVEL>;
+
+    //! Formats log entries recorded meanwhile into Backend::log(). Called by idle().
+    //! \param max_entries number of entries formatted at most
+    void flushLog(uint8_t max_entries = 4) { log_buffer.flush(Backend::log(), max_entries); }
+
+    //! \return the log buffer, i.e. to query the number of entries dropped
+    const LogBuffer &getLogBuffer() const { return log_buffer; }
+
+    //! Called with the state of the ring when idle, i.e. StateStore::observe() to persist it.
+    using StateObserver = void (*)(void *context, const RingState &state, uint32_t time_ms);
+
+    //! Sets the function observing the state, see StateStore::attach().
+    //! \param observer nullptr removes the observer
+    void setStateObserver(StateObserver observer, void *context)
+    {
+        state_observer = observer;
+        state_observer_context = context;
+    }
+
+    //! Hands the state over to the state observer (if any) unless held. Called by idle().
+    void flushState()
+    {
+        if(state_observer && !state_held)
+            state_observer(state_observer_context, getState(), Backend::millis());
+    }
+
+    //! Holds the state back from the state observer, i.e. while a Timeline plays, so that a show
+    //! does not persist each of its keyframes. The state is handed over again once released.
+    void holdState(bool hold) { state_held = hold; }
+
+    bool isStateHeld() const { return state_held; }
+
+    //! \return scene, brightness, on/off and arc
+    RingState getState() const;
+
+    //! Takes over a state kept from before a reset: the brightness applies at once and the scene
+    //! starts over, without a transition. Called before setup(), setup() shows the first frame of
+    //! the state then rather than turning the strip off.
+    //! \return false if the state is of another scene list or its scene is not in the list,
+    //! nothing is restored then; the arc is reset to full width if the state is of another LED
+    //! count
+    bool restore(const RingState &state);
+
+    // scene interface: used by the scenes to draw into the frame
+
+    //! Marks the frame to be transmitted by the next flush().
+    void emitFrame() { frame_pending = true; }
+
+    //! Counts a due frame which is not emitted since it would be identical to the previous one.
+    void skipFrame() { ++frame_counters.skipped; }
+
+protected:
+    //! Arc based abstraction of the strip, i.e. the range of the arc layer.
+    struct ArcBasedView
+    {
+        ArcBasedView();
+
+        void rotate(int8_t pixels = 1);
+
+        void incrementArc(int8_t pixels = 1);
+
+        void fullWidth();
+
+        //! \return first pixel of the arc
+        uint16_t first() const { return begin; }
+
+        //! \return last pixel of the arc
+        uint16_t last() const { return end; }
+
+        //! \param first first pixel of the arc
+        //! \param last last pixel of the arc, first - 1 for the full width
+        void set(uint16_t first, uint16_t last)
+        {
+            begin = first;
+            end = last;
+        }
+
+        //! \return number of pixels of the arc, 1 at least
+        uint16_t width() const
+        {
+            const uint16_t from = begin, to = end;
+            return static_cast<uint16_t>((to + LED_COUNT - from) % LED_COUNT + 1);
+        }
+
+    private:
+        void incrementArcByOne(bool do_increment);
+
+        CappedNumber<LED_COUNT> begin;
+        CappedNumber<LED_COUNT> end;
+        //! toggle bit to ensures alternate access (left, right)
+        uint8_t toggle : 1;
+        uint8_t _stuff : 7;
+    };
+
+    Ring &ring() { return static_cast<Ring &>(*this); }
+
+    //! Applies the arc to its layer.
+    void updateArcLayer();
+
+    //! Applies the commands posted so far.
+    void applyCommands();
+
+    //! Records a message into the log buffer, compiled out above PIXELRING_LOG_LEVEL.
+    template <LogMessage MESSAGE> void log(int16_t value = 0)
+    {
+        log_buffer.template record<MESSAGE>(Backend::millis(), value);
+    }
+
+    //! Switches to the given scene which starts over with a fresh animation state, unless it is
+    //! marked resumed and not restarted.
+    void enterScene(uint8_t index, bool restart = false);
+
+    //! Recomputes the fixed point brightness scale after brightness or on/off changed.
+    void updateBrightnessScale();
+
+    //! Moves the brightness scale towards its target by the given time.
+    void easeBrightness(uint32_t dt_ms);
+
+    //! 0-100 [%]
+    uint8_t brightness{ 100 };
+    //! 0-1 (on, off)
+    uint8_t brightness_override{ 1 };
+    //! brightness and brightness_override as fixed point scale 0-256, eased towards target
+    uint16_t brightness_scale{ BrightnessScale::max_scale };
+    uint16_t brightness_target{ BrightnessScale::max_scale };
+    uint16_t brightness_easing_ms{ 0 };
+
+    //! Active scene and its animation state. The active scene resumes from its state on each
+    //! process(), entering a scene (again) resets it unless the scene is marked resumed (see
+    //! SceneList), restartScene() resets it anyway.
+    SceneTable scenes{ (SceneTable::template indexOf<FirstScene>() < SceneTable::size) ?
+                       SceneTable::template indexOf<FirstScene>() :
+                       uint8_t{ 0 } };
+
+    //! paces the frames of all scenes
+    FrameScheduler<Backend> scheduler;
+
+    //! arc based abstraction of the strip
+    ArcBasedView arc_view;
+
+    //! arcs, masks and overlays of all scenes
+    Layers layers;
+    //! layer id of the arc
+    uint8_t arc_layer{ layers.addArc(0, LED_COUNT) };
+
+    //! posted by other threads, applied by render()
+    CommandQueue<Command, PIXELRING_COMMAND_QUEUE> commands;
+
+    FrameCounters frame_counters;
+    Stats stats;
+    LogBuffer log_buffer;
+    uint32_t stats_interval_ms{ 0 };
+    uint32_t stats_dumped_ms{ 0 };
+    StateObserver state_observer{ nullptr };
+    void *state_observer_context{ nullptr };
+    bool state_held{ false };
+    //! frame was rendered but not transmitted yet
+    bool frame_pending{ false };
+    //! a state was restored, setup() shows its first frame
+    bool restored{ false };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+bool RingControl<R, B, S, LC, F, T>::render(const FrameTick &tick)
+{
+    applyCommands();
+
+    if(tick.frames > 0)
+        stats.tick(scenes.current(), tick, SceneTable::stepMs(scenes.current()));
+
+    for(uint8_t frame = 0; frame < tick.frames; frame++)
+    {
+        const uint32_t start_us = Stats::enabled ? B::micros() : 0;
+        const uint32_t skipped = frame_counters.skipped;
+
+        const uint16_t dt_ms = tick.sceneDtMs(frame);
+        easeBrightness(dt_ms);
+        ring().renderFrame(dt_ms);
+
+        if(Stats::enabled)
+            stats.rendered(B::micros() - start_us, frame_counters.skipped != skipped);
+    }
+
+    return frame_pending;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::idle()
+{
+    flushLog();
+    flushState();
+    if(stats_interval_ms > 0 && B::millis() - stats_dumped_ms >= stats_interval_ms)
+    {
+        stats.dump(B::log());
+        stats_dumped_ms = B::millis();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::incrementBrightness(int8_t increment)
+{
+    brightness = BrightnessScale::stepPercent(brightness, increment);
+    updateBrightnessScale();
+    log<LogMessage::Brightness>(brightness);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::maxBrightness()
+{
+    brightness = 100;
+    updateBrightnessScale();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::setBrightness(uint8_t percent)
+{
+    brightness = (percent < 5) ? 5 : (percent > 100) ? 100 : percent;
+    updateBrightnessScale();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::updateBrightnessScale()
+{
+    brightness_target = BrightnessScale::fromPercent(brightness, brightness_override != 0);
+    if(brightness_easing_ms == 0)
+        brightness_scale = brightness_target;
+    layers.setScale(brightness_scale);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::easeBrightness(uint32_t dt_ms)
+{
+    if(brightness_scale == brightness_target)
+        return;
+
+    // the full range takes brightness_easing_ms, at least one step per frame
+    const uint32_t full_step = (brightness_easing_ms == 0) ?
+                               BrightnessScale::max_scale :
+                               dt_ms * BrightnessScale::max_scale / brightness_easing_ms;
+    const int32_t step = (full_step == 0)                         ? 1 :
+                         (full_step > BrightnessScale::max_scale) ? BrightnessScale::max_scale :
+                                                                    static_cast<int32_t>(full_step);
+
+    if(brightness_scale < brightness_target)
+        brightness_scale = (brightness_target - brightness_scale > step) ?
+                           static_cast<uint16_t>(brightness_scale + step) :
+                           brightness_target;
+    else
+        brightness_scale = (brightness_scale - brightness_target > step) ?
+                           static_cast<uint16_t>(brightness_scale - step) :
+                           brightness_target;
+    layers.setScale(brightness_scale);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+bool RingControl<R, B, S, LC, F, T>::toggleOnOff()
+{
+    if(brightness_override == 1)
+    {
+        off();
+    }
+    else
+    {
+        on();
+        return true;
+    }
+    return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::off()
+{
+    brightness_override = 0;
+    updateBrightnessScale();
+    log<LogMessage::Off>();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::on()
+{
+    brightness_override = 1;
+    updateBrightnessScale();
+    log<LogMessage::On>();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::incrementWidth(int8_t pixels)
+{
+    log<LogMessage::Width>(pixels);
+    arc_view.incrementArc(pixels);
+    updateArcLayer();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::fullWidth()
+{
+    arc_view.fullWidth();
+    updateArcLayer();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::shift(int8_t pixels)
+{
+    arc_view.rotate(pixels);
+    updateArcLayer();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::setArc(uint16_t begin, uint16_t width)
+{
+    const uint16_t first = begin % LC;
+    const uint16_t length = (width == 0) ? 1 : (width > LC) ? LC : width;
+    arc_view.set(first, static_cast<uint16_t>((first + length - 1) % LC));
+    updateArcLayer();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::updateArcLayer()
+{
+    layers.setRange(arc_layer, arc_view.first(), arc_view.width());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::applyCommands()
+{
+    // the state is stepped per command, the arc layer, the brightness scale and the scene are
+    // updated (and logged like the direct calls) once for all of them
+    bool arc_changed = false;
+    bool brightness_changed = false;
+    bool brightness_stepped = false;
+    bool on_off_changed = false;
+    bool width_changed = false;
+    int16_t width_pixels = 0;
+    bool restart = false;
+    // a RestartScene after the last scene change resets a resumed scene, like restartScene()
+    bool force_restart = false;
+    uint8_t scene = scenes.current();
+
+    using Kind = typename Command::Kind;
+    Command command;
+    while(commands.pop(command))
+    {
+        switch(command.kind)
+        {
+        case Kind::Brightness:
+            brightness =
+            BrightnessScale::stepPercent(brightness, static_cast<int8_t>(command.value));
+            brightness_changed = true;
+            brightness_stepped = true;
+            break;
+        case Kind::MaxBrightness:
+            brightness = 100;
+            brightness_changed = true;
+            break;
+        case Kind::ToggleOnOff:
+            brightness_override = (brightness_override == 1) ? 0 : 1;
+            brightness_changed = true;
+            on_off_changed = true;
+            break;
+        case Kind::On:
+        case Kind::Off:
+            brightness_override = (command.kind == Kind::On) ? 1 : 0;
+            brightness_changed = true;
+            on_off_changed = true;
+            break;
+        case Kind::Width:
+            arc_view.incrementArc(static_cast<int8_t>(command.value));
+            arc_changed = true;
+            width_changed = true;
+            width_pixels = static_cast<int16_t>(width_pixels + static_cast<int8_t>(command.value));
+            break;
+        case Kind::FullWidth:
+            arc_view.fullWidth();
+            arc_changed = true;
+            break;
+        case Kind::Shift:
+            arc_view.rotate(static_cast<int8_t>(command.value));
+            arc_changed = true;
+            break;
+        case Kind::NextScene:
+            scene = SceneTable::next(scene);
+            restart = true;
+            force_restart = false;
+            break;
+        case Kind::RestartScene:
+            restart = true;
+            force_restart = true;
+            break;
+        case Kind::SetScene:
+            if(static_cast<uint8_t>(command.value) != scene)
+            {
+                restart = true;
+                force_restart = false;
+            }
+            scene = static_cast<uint8_t>(command.value);
+            break;
+        }
+    }
+
+    if(arc_changed)
+        updateArcLayer();
+    if(brightness_changed)
+        updateBrightnessScale();
+
+    if(width_changed)
+        log<LogMessage::Width>(width_pixels);
+    if(brightness_stepped)
+        log<LogMessage::Brightness>(brightness);
+    if(on_off_changed && brightness_override != 0)
+        log<LogMessage::On>();
+    else if(on_off_changed)
+        log<LogMessage::Off>();
+
+    if(restart && scene < SceneTable::size)
+        enterScene(scene, force_restart);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::nextScene()
+{
+    enterScene(SceneTable::next(scenes.current()));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::restartScene()
+{
+    enterScene(scenes.current(), true);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::setScene(uint8_t index)
+{
+    if(index >= SceneTable::size || index == scenes.current())
+        return;
+    enterScene(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+RingState RingControl<R, B, S, LC, F, T>::getState() const
+{
+    RingState state;
+    state.scene_list = SceneTable::fingerprint;
+    state.led_count = LC;
+    state.arc_begin = arc_view.first();
+    state.arc_end = arc_view.last();
+    state.scene = scenes.current();
+    state.brightness = brightness;
+    state.on = brightness_override != 0;
+    return state;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+bool RingControl<R, B, S, LC, F, T>::restore(const RingState &state)
+{
+    if(state.scene_list != SceneTable::fingerprint || state.scene >= SceneTable::size)
+        return false;
+
+    brightness = (state.brightness < 5) ? 5 : (state.brightness > 100) ? 100 : state.brightness;
+    brightness_override = state.on ? 1 : 0;
+    updateBrightnessScale();
+    brightness_scale = brightness_target;
+    layers.setScale(brightness_scale);
+
+    if(state.led_count == LC && state.arc_begin < LC && state.arc_end < LC)
+        arc_view.set(state.arc_begin, state.arc_end);
+    else
+        arc_view.fullWidth();
+    updateArcLayer();
+
+    ring().sceneChanging(true);
+    scenes.enter(state.scene, true);
+    scheduler.restart();
+    restored = true;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::enterScene(uint8_t index, bool restart)
+{
+    ring().sceneChanging(false);
+    scenes.enter(index, restart);
+    scheduler.restart();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+RingControl<R, B, S, LC, F, T>::ArcBasedView::ArcBasedView() : begin(0), end(LC - 1), toggle(0)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::ArcBasedView::rotate(int8_t pixels)
+{
+    begin += pixels;
+    end += pixels;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::ArcBasedView::incrementArc(int8_t pixels)
+{
+    while(pixels < 0)
+    {
+        incrementArcByOne(false);
+        ++pixels;
+    }
+
+    while(pixels > 0)
+    {
+        incrementArcByOne(true);
+        --pixels;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::ArcBasedView::incrementArcByOne(bool do_increment)
+{
+    int8_t increment = do_increment ? 1 : -1;
+
+    // disallow underflow
+    if(!do_increment && begin == end)
+        return;
+
+    uint16_t previous_begin = begin, previous_end = end;
+
+    // do the increment
+    if(toggle++ == 0)
+    {
+        begin -= increment;
+    }
+    else
+    {
+        end += increment;
+    }
+
+    // revert on overflow
+    if(do_increment && begin == end)
+    {
+        end = previous_end;
+        begin = previous_begin;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename R, typename B, typename S, uint16_t LC, typename F, bool T>
+void RingControl<R, B, S, LC, F, T>::ArcBasedView::fullWidth()
+{
+    begin = 0;
+    end = 0;
+    --end;
+}
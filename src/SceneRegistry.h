@@ -0,0 +1,351 @@
+#pragma once
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "IndexSequence.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Type list of scenes. A scene is a type providing
+//!
+//!     struct State { ... };                  // animation state, default constructed on entering
+//!     static constexpr bool cycled = true;   // whether nextScene() visits the scene
+//!     template <typename Ring> static void render(Ring &ring, State &state, uint16_t dt_ms);
+//!
+//! Scenes may declare static constexpr bool resumed = true to continue from the state they were
+//! left with when entered again, rather than starting over, see SceneRegistry::enter(). Scenes
+//! advancing in steps of a fixed interval declare it as static constexpr uint16_t step_ms, their
+//! frames are due within a step then rather than within a frame period, see FrameStats.
+//!
+//! see Scenes.h for examples. Scenes keeping a state per pixel provide a state for any number of
+//! pixels instead, see EffectScenes.h:
+//!
+//!     template <uint16_t LED_COUNT> struct PixelState { ... };
+//!     template <typename Ring>
+//!     static void render(Ring &ring, PixelState<Ring::led_count> &state, uint16_t dt_ms);
+template <typename... Scenes> struct SceneList
+{
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Position of Scene within Scenes..., sizeof...(Scenes) if not contained.
+template <typename Scene, typename... Scenes> struct SceneIndexOf;
+
+template <typename Scene> struct SceneIndexOf<Scene>
+{
+    static constexpr uint8_t value = 0;
+};
+
+template <typename Scene, typename... Scenes> struct SceneIndexOf<Scene, Scene, Scenes...>
+{
+    static constexpr uint8_t value = 0;
+};
+
+template <typename Scene, typename Other, typename... Scenes>
+struct SceneIndexOf<Scene, Other, Scenes...>
+{
+    static constexpr uint8_t value = 1 + SceneIndexOf<Scene, Scenes...>::value;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Whether the scene at the given index of Scenes... is visited by nextScene().
+template <typename... Scenes> struct SceneCycled;
+
+template <> struct SceneCycled<>
+{
+    static constexpr bool at(uint8_t) { return false; }
+};
+
+template <typename Scene, typename... Scenes> struct SceneCycled<Scene, Scenes...>
+{
+    static constexpr bool at(uint8_t index)
+    {
+        return (index == 0) ? Scene::cycled : SceneCycled<Scenes...>::at(index - 1);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! State of a scene on a ring of LED_COUNT pixels: Scene::PixelState<LED_COUNT> if provided,
+//! Scene::State otherwise.
+template <typename Scene, uint16_t LED_COUNT, typename = void> struct SceneStateOf
+{
+    using type = typename Scene::State;
+};
+
+template <typename Scene, uint16_t LED_COUNT>
+struct SceneStateOf<Scene,
+                    LED_COUNT,
+                    decltype(void(sizeof(typename Scene::template PixelState<LED_COUNT>)))>
+{
+    using type = typename Scene::template PixelState<LED_COUNT>;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Interval a scene advances in: Scene::step_ms if provided, 0 otherwise.
+template <typename Scene, typename = void> struct SceneStepMs
+{
+    static constexpr uint16_t value = 0;
+};
+
+template <typename Scene> struct SceneStepMs<Scene, decltype(void(Scene::step_ms))>
+{
+    static constexpr uint16_t value = Scene::step_ms;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Whether the scene keeps its state while other scenes are active: Scene::resumed if provided.
+template <typename Scene, typename = void> struct SceneResumed : std::false_type
+{
+};
+
+template <typename Scene>
+struct SceneResumed<Scene, typename std::enable_if<Scene::resumed>::type> : std::true_type
+{
+};
+
+//! Size of the own storage of a scene on a ring of LED_COUNT pixels, a multiple of ALIGN; 0 if the
+//! scene is not marked resumed.
+template <typename Scene, uint16_t LED_COUNT, size_t ALIGN> struct SceneKeptSize
+{
+    static constexpr size_t value =
+    SceneResumed<Scene>::value
+    ? (sizeof(typename SceneStateOf<Scene, LED_COUNT>::type) + ALIGN - 1) / ALIGN * ALIGN
+    : 0;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Fingerprint of a scene list on a ring of LED_COUNT pixels: covers the number of scenes, the
+//! sizes of their states and whether they are cycled and resumed, so that a state kept for another
+//! scene list is not taken for this one (see RingState). Scene lists differing only in the order
+//! or the parameters of scenes alike share their fingerprint.
+template <uint16_t LED_COUNT, typename... Scenes> struct SceneFingerprint;
+
+template <uint16_t LED_COUNT> struct SceneFingerprint<LED_COUNT>
+{
+    static constexpr uint16_t value = 0x5343;
+};
+
+template <uint16_t LED_COUNT, typename Scene, typename... Scenes>
+struct SceneFingerprint<LED_COUNT, Scene, Scenes...>
+{
+    static constexpr uint16_t value = static_cast<uint16_t>(
+    SceneFingerprint<LED_COUNT, Scenes...>::value * 31U +
+    sizeof(typename SceneStateOf<Scene, LED_COUNT>::type) * 4U + (Scene::cycled ? 1U : 0U) +
+    (SceneResumed<Scene>::value ? 2U : 0U));
+};
+
+//--------------------------------------------------------------------------------------------------
+
+template <size_t... V> struct SumOf;
+
+template <> struct SumOf<>
+{
+    static constexpr size_t value = 0;
+};
+
+template <size_t V, size_t... Vs> struct SumOf<V, Vs...>
+{
+    static constexpr size_t value = V + SumOf<Vs...>::value;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+template <size_t... V> struct MaxOf;
+
+template <size_t V> struct MaxOf<V>
+{
+    static constexpr size_t value = V;
+};
+
+template <size_t V, size_t... Vs> struct MaxOf<V, Vs...>
+{
+    static constexpr size_t value = (V > MaxOf<Vs...>::value) ? V : MaxOf<Vs...>::value;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Cycling order of a scene list: successor of each scene, skipping the ones not cycled.
+template <typename Sequence, typename... Scenes> struct SceneCycle;
+
+template <uint16_t... I, typename... Scenes> struct SceneCycle<IndexSequence<I...>, Scenes...>
+{
+    static constexpr uint8_t size = sizeof...(Scenes);
+
+    //! \return first cycled scene after index (wrapping around), index itself if none is cycled
+    static constexpr uint8_t next(uint8_t index, uint8_t distance = 1)
+    {
+        return (distance > size) ? index
+               : SceneCycled<Scenes...>::at((index + distance) % size)
+               ? static_cast<uint8_t>((index + distance) % size)
+               : next(index, distance + 1);
+    }
+
+    static constexpr uint8_t successors[size] = { next(I)... };
+};
+
+template <uint16_t... I, typename... Scenes>
+constexpr uint8_t SceneCycle<IndexSequence<I...>, Scenes...>::successors[];
+
+//--------------------------------------------------------------------------------------------------
+
+//! Dispatches to the active scene of a scene list. Dispatch, cycling order and state storage are
+//! generated at compile time, only the listed scenes are instantiated. The states of the scenes
+//! share one storage since only the active scene holds a state, except for the scenes marked
+//! resumed (see SceneList), which keep a storage of their own. Unless PREVIOUS is false the scene
+//! left last keeps a copy of its state in a second storage, so it can still be rendered during a
+//! transition. Scene states are therefore required to be trivially copyable.
+//!
+//! \tparam LED_COUNT number of pixels of the ring, which is incomplete yet, sizes PixelState
+//! \tparam PREVIOUS whether the previous scene is rendered, see renderPrevious()
+template <typename Ring, typename List, uint16_t LED_COUNT, bool PREVIOUS = true>
+class SceneRegistry;
+
+template <typename Ring, typename... Scenes, uint16_t LED_COUNT, bool PREVIOUS>
+class SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>
+{
+    static_assert(sizeof...(Scenes) > 0, "at least one scene is required");
+    static_assert(sizeof...(Scenes) < 255, "too many scenes");
+
+public:
+    static constexpr uint8_t size = sizeof...(Scenes);
+
+    //! identifies the scene list, see SceneFingerprint
+    static constexpr uint16_t fingerprint = SceneFingerprint<LED_COUNT, Scenes...>::value;
+
+    //! \return the index of Scene in the list, size if not contained
+    template <typename Scene> static constexpr uint8_t indexOf()
+    {
+        return SceneIndexOf<Scene, Scenes...>::value;
+    }
+
+    //! \param initial index of the scene to start with
+    explicit SceneRegistry(uint8_t initial) : active((initial < size) ? initial : 0)
+    {
+        for(uint8_t index = 0; index < size; index++)
+        {
+            if(kept_sizes[index] > 0)
+                enter_table[index](stateOf(index));
+        }
+        enter_table[active](stateOf(active));
+        if(PREVIOUS)
+            enter_table[active](&previous_state);
+        previous = active;
+    }
+
+    //! Switches to the given scene, with a default constructed state unless the scene is marked
+    //! resumed and not restarted, it continues from the state it was left with then. The scene
+    //! left becomes the previous scene.
+    //! \param restart starts a scene marked resumed over as well
+    void enter(uint8_t index, bool restart = false)
+    {
+        previous = active;
+        if(PREVIOUS)
+            copy_table[active](&previous_state, stateOf(active));
+        active = (index < size) ? index : 0;
+        if(restart || kept_sizes[active] == 0)
+            enter_table[active](stateOf(active));
+    }
+
+    //! Renders one frame of the active scene.
+    void render(Ring &ring, uint16_t dt_ms) { render_table[active](ring, stateOf(active), dt_ms); }
+
+    //! Renders one frame of the previous scene, continuing from the state it was left with. Does
+    //! nothing unless PREVIOUS.
+    void renderPrevious(Ring &ring, uint16_t dt_ms)
+    {
+        if(PREVIOUS)
+            render_table[previous](ring, &previous_state, dt_ms);
+    }
+
+    //! \return index of the active scene
+    uint8_t current() const { return active; }
+
+    //! \return the scene succeeding the given one in cycling order
+    static uint8_t next(uint8_t index) { return (index < size) ? Cycle::successors[index] : 0; }
+
+    //! \return interval the scene advances in, 0 if it does not declare one
+    static uint16_t stepMs(uint8_t index) { return (index < size) ? step_table[index] : 0; }
+
+private:
+    using Cycle = SceneCycle<typename MakeIndexSequence<size>::type, Scenes...>;
+    using RenderFunction = void (*)(Ring &, void *, uint16_t);
+    using EnterFunction = void (*)(void *);
+    using CopyFunction = void (*)(void *, const void *);
+
+    template <typename Scene> using StateOf = typename SceneStateOf<Scene, LED_COUNT>::type;
+
+    template <typename Scene> static void renderScene(Ring &ring, void *state, uint16_t dt_ms)
+    {
+        Scene::render(ring, *static_cast<StateOf<Scene> *>(state), dt_ms);
+    }
+
+    template <typename Scene> static void enterScene(void *state) { new(state) StateOf<Scene>(); }
+
+    template <typename Scene> static void copyScene(void *state, const void *other)
+    {
+        new(state) StateOf<Scene>(*static_cast<const StateOf<Scene> *>(other));
+    }
+
+    static constexpr size_t state_align = MaxOf<alignof(StateOf<Scenes>)...>::value;
+
+    template <typename Scene> using KeptSize = SceneKeptSize<Scene, LED_COUNT, state_align>;
+
+    //! \return storage of the state of the scene at the index
+    void *stateOf(uint8_t index)
+    {
+        if(kept_sizes[index] == 0)
+            return &state;
+        size_t offset = 0;
+        for(uint8_t other = 0; other < index; other++)
+            offset += kept_sizes[other];
+        return reinterpret_cast<uint8_t *>(&kept) + offset;
+    }
+
+    static constexpr RenderFunction render_table[size] = { &renderScene<Scenes>... };
+    static constexpr EnterFunction enter_table[size] = { &enterScene<Scenes>... };
+    static constexpr CopyFunction copy_table[size] = { &copyScene<Scenes>... };
+    static constexpr size_t kept_sizes[size] = { KeptSize<Scenes>::value... };
+    static constexpr uint16_t step_table[size] = { SceneStepMs<Scenes>::value... };
+
+    using State = typename std::aligned_storage<MaxOf<sizeof(StateOf<Scenes>)...>::value,
+                                                state_align>::type;
+    //! own storages of the scenes marked resumed, one after the other
+    static constexpr size_t kept_size = SumOf<KeptSize<Scenes>::value...>::value;
+    using Kept = typename std::aligned_storage<(kept_size > 0) ? kept_size : 1, state_align>::type;
+
+    //! copy of the state of the previous scene, a placeholder unless PREVIOUS
+    using PreviousState = typename std::conditional<
+    PREVIOUS, State, typename std::aligned_storage<1, 1>::type>::type;
+
+    State state;
+    PreviousState previous_state;
+    Kept kept;
+    uint8_t active{ 0 };
+    uint8_t previous{ 0 };
+};
+
+template <typename Ring, typename... Scenes, uint16_t LED_COUNT, bool PREVIOUS>
+constexpr typename SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::RenderFunction
+SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::render_table[];
+
+template <typename Ring, typename... Scenes, uint16_t LED_COUNT, bool PREVIOUS>
+constexpr typename SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::EnterFunction
+SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::enter_table[];
+
+template <typename Ring, typename... Scenes, uint16_t LED_COUNT, bool PREVIOUS>
+constexpr typename SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::CopyFunction
+SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::copy_table[];
+
+template <typename Ring, typename... Scenes, uint16_t LED_COUNT, bool PREVIOUS>
+constexpr size_t SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::kept_sizes[];
+
+template <typename Ring, typename... Scenes, uint16_t LED_COUNT, bool PREVIOUS>
+constexpr uint16_t SceneRegistry<Ring, SceneList<Scenes...>, LED_COUNT, PREVIOUS>::step_table[];
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <stdint.h>
+#include "HueTable.h"
+#include "SceneRegistry.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Animation phase of a scene which advances in steps of a fixed duration.
+struct ScenePhase
+{
+    //! \return true if the current step was not rendered yet
+    bool due(uint16_t step_ms) const { return !rendered || step(step_ms) != rendered_step; }
+
+    //! \return true if the current step was not rendered yet or not with the given revision of the
+    //! composition, see Compositor::revision()
+    bool due(uint16_t step_ms, uint16_t revision) const
+    {
+        return due(step_ms) || revision != rendered_revision;
+    }
+
+    uint32_t step(uint16_t step_ms) const { return ms / step_ms; }
+
+    //! Marks the current step as rendered and advances the time.
+    void advance(uint16_t step_ms, uint32_t dt_ms)
+    {
+        rendered_step = step(step_ms);
+        rendered = true;
+        ms += dt_ms;
+    }
+
+    //! Marks the current step as rendered with the given revision and advances the time.
+    void advance(uint16_t step_ms, uint32_t dt_ms, uint16_t revision)
+    {
+        rendered_revision = revision;
+        advance(step_ms, dt_ms);
+    }
+
+    //! animation time since the scene was entered in [ms]
+    uint32_t ms{ 0 };
+    //! step rendered last
+    uint32_t rendered_step{ 0 };
+    //! revision of the composition rendered last
+    uint16_t rendered_revision{ 0 };
+    //! false until the first step is rendered, the revision wraps around and has no spare value
+    bool rendered{ false };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Solid color on the arcs, see PixelRing::incrementWidth(), PixelRing::shift() and
+//! Compositor::addArc().
+template <uint8_t R, uint8_t G, uint8_t B> struct ArcScene
+{
+    struct State
+    {
+        //! revision of the composition rendered last
+        uint16_t rendered_revision{ 0 };
+        bool rendered{ false };
+    };
+
+    static constexpr bool cycled = true;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t)
+    {
+        // nothing changes unless the composition does, i.e. the arc or the brightness
+        if(state.rendered && state.rendered_revision == ring.getLayers().revision())
+        {
+            ring.skipFrame();
+            return;
+        }
+
+        state.rendered_revision = ring.getLayers().revision();
+        state.rendered = true;
+        ring.composeColor(Ring::Strip::Color(R, G, B));
+        ring.emitFrame();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Every third pixel lit in the given color, shifted by one pixel each STEP_MS.
+template <uint8_t R, uint8_t G, uint8_t B, uint16_t STEP_MS = 50> struct TheaterChaseScene
+{
+    using State = ScenePhase;
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring> static void render(Ring &ring, State &phase, uint16_t dt_ms)
+    {
+        const uint16_t revision = ring.getLayers().revision();
+        if(!phase.due(STEP_MS, revision))
+        {
+            phase.advance(STEP_MS, dt_ms, revision);
+            ring.skipFrame();
+            return;
+        }
+
+        const uint16_t b = phase.step(STEP_MS) % 3;
+        phase.advance(STEP_MS, dt_ms, revision);
+
+        const uint32_t color = Ring::Strip::Color(R, G, B);
+        // every third pixel from 'b' on is set to 'color', all others are off
+        ring.compose([b, color](uint16_t pixel) { return (pixel % 3 == b) ? color : 0; });
+        ring.emitFrame(); // Update strip with new contents
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Color wheel along the strip, rotating by 256 (of 65536) each STEP_MS.
+template <uint16_t STEP_MS = 10> struct RainbowSceneT
+{
+    using State = ScenePhase;
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring> static void render(Ring &ring, State &phase, uint16_t dt_ms)
+    {
+        const uint16_t revision = ring.getLayers().revision();
+        if(!phase.due(STEP_MS, revision))
+        {
+            phase.advance(STEP_MS, dt_ms, revision);
+            ring.skipFrame();
+            return;
+        }
+
+        // Hue of first pixel runs through the color wheel, adding 256 each step.
+        // Color wheel has a range of 65536 and it's OK if we roll over.
+        const uint16_t firstPixelHue = static_cast<uint16_t>(phase.step(STEP_MS) * 256);
+        phase.advance(STEP_MS, dt_ms, revision);
+
+        ring.compose([firstPixelHue](uint16_t pixel) -> uint32_t {
+            // Offset pixel hue by an amount to make one full revolution of the
+            // color wheel (range of 65536) along the length of the strip:
+            const uint16_t pixelHue =
+            static_cast<uint16_t>(firstPixelHue + Ring::HueOffsets::get(pixel));
+            // The gamma corrected hue -> RGB conversion is looked up in flash rather than
+            // computed by means of strip.gamma32(strip.ColorHSV(pixelHue)):
+            return HueGammaTable::color(pixelHue);
+        });
+        ring.emitFrame(); // Update strip with new contents
+    }
+};
+
+using RainbowScene = RainbowSceneT<>;
+
+//--------------------------------------------------------------------------------------------------
+
+//! Every third pixel lit along the color wheel, shifted by one pixel each STEP_MS.
+template <uint16_t STEP_MS = 50> struct TheaterChaseRainbowSceneT
+{
+    using State = ScenePhase;
+
+    static constexpr bool cycled = true;
+    static constexpr uint16_t step_ms = STEP_MS;
+
+    template <typename Ring> static void render(Ring &ring, State &phase, uint16_t dt_ms)
+    {
+        const uint16_t revision = ring.getLayers().revision();
+        if(!phase.due(STEP_MS, revision))
+        {
+            phase.advance(STEP_MS, dt_ms, revision);
+            ring.skipFrame();
+            return;
+        }
+
+        const uint32_t step = phase.step(STEP_MS);
+        const uint16_t b = step % 3;
+        // First pixel starts at red (hue 0), one cycle of color wheel over 90 steps
+        const uint16_t firstPixelHue = static_cast<uint16_t>(step * (65536 / 90));
+        phase.advance(STEP_MS, dt_ms, revision);
+
+        // every third pixel from 'b' on is lit, all others are off
+        ring.compose([b, firstPixelHue](uint16_t pixel) -> uint32_t {
+            if(pixel % 3 != b)
+                return 0;
+            // hue of the pixel is offset by an amount to make one full
+            // revolution of the color wheel (range 65536) along the length
+            // of the strip:
+            const uint16_t hue =
+            static_cast<uint16_t>(firstPixelHue + Ring::HueOffsets::get(pixel));
+            return HueGammaTable::color(hue); // hue -> RGB
+        });
+        ring.emitFrame(); // Update strip with new contents
+    }
+};
+
+using TheaterChaseRainbowScene = TheaterChaseRainbowSceneT<>;
+
+//--------------------------------------------------------------------------------------------------
+
+//! Pixels received from the pixel input of the ring, see PixelRing::setPixelInput() and
+//! AdalightInput. The brightness applies, the layers do not. Not visited by nextScene().
+struct StreamScene
+{
+    struct State
+    {
+    };
+
+    static constexpr bool cycled = false;
+
+    template <typename Ring> static void render(Ring &ring, State &, uint16_t)
+    {
+        if(ring.receivePixels())
+            ring.emitFrame();
+        else
+            ring.skipFrame();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Turns all pixels off, at once or one by one, see PixelRing::setWipeInterval(). Once the strip
+//! is cleared no more frames are emitted. Not visited by nextScene().
+struct OffScene
+{
+    struct State
+    {
+        //! number of pixels already cleared
+        uint16_t filled{ 0 };
+        ScenePhase phase;
+    };
+
+    static constexpr bool cycled = false;
+
+    template <typename Ring> static void render(Ring &ring, State &state, uint16_t dt_ms)
+    {
+        const uint16_t led_count = Ring::led_count;
+        const uint16_t wait_ms = ring.getWipeInterval();
+        uint8_t *pixels = ring.getStrip().getPixels();
+
+        if(state.filled >= led_count)
+        {
+            ring.skipFrame();
+            return;
+        }
+
+        if(wait_ms == 0)
+        {
+            Ring::Pixels::clear(pixels, 0, led_count);
+            state.filled = led_count;
+        }
+        else
+        {
+            // one more pixel each wait_ms
+            const uint32_t step = state.phase.step(wait_ms);
+            const uint16_t target =
+            (step + 1 < led_count) ? static_cast<uint16_t>(step + 1) : led_count;
+            state.phase.advance(wait_ms, dt_ms);
+            if(target <= state.filled)
+            {
+                ring.skipFrame();
+                return;
+            }
+
+            Ring::Pixels::clear(pixels, state.filled, target - state.filled);
+            state.filled = target;
+        }
+
+        ring.emitFrame();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+using WhiteScene = ArcScene<255, 255, 255>;
+using RedScene = ArcScene<255, 0, 0>;
+using GreenScene = ArcScene<0, 255, 0>;
+using BlueScene = ArcScene<0, 0, 255>;
+using TheaterChaseWhiteScene = TheaterChaseScene<127, 127, 127>;
+using TheaterChaseRedScene = TheaterChaseScene<127, 0, 0>;
+using TheaterChaseBlueScene = TheaterChaseScene<0, 0, 127>;
+
+//! All built-in scenes, in the order of PixelRing::SceneMode.
+using DefaultScenes = SceneList<WhiteScene,
+                                RedScene,
+                                GreenScene,
+                                BlueScene,
+                                TheaterChaseWhiteScene,
+                                TheaterChaseRedScene,
+                                TheaterChaseBlueScene,
+                                TheaterChaseRainbowScene,
+                                RainbowScene,
+                                OffScene,
+                                StreamScene>;
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Settings of a ring worth keeping across a reset, see RingControl::getState() and
+//! RingControl::restore().
+struct RingState
+{
+    //! fingerprint of the scene list the scene refers to, see SceneFingerprint
+    uint16_t scene_list{ 0 };
+    //! number of pixels the arc refers to
+    uint16_t led_count{ 0 };
+    //! first and last pixel of the arc
+    uint16_t arc_begin{ 0 };
+    uint16_t arc_end{ 0 };
+    //! position of the scene in the scene list
+    uint8_t scene{ 0 };
+    //! 5-100 [%]
+    uint8_t brightness{ 100 };
+    bool on{ true };
+
+    bool sameSettings(const RingState &other) const
+    {
+        return scene_list == other.scene_list && led_count == other.led_count &&
+               arc_begin == other.arc_begin && arc_end == other.arc_end && scene == other.scene &&
+               brightness == other.brightness && on == other.on;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Binary format of a state record. All numbers are little endian.
+//!
+//!     'P' 'S' version sequence:u16 led_count:u16 scene:u8 brightness:u8 flags:u8
+//!     arc_begin:u16 arc_end:u16 scene_list:u16 crc:u16
+//!
+//! flags bit 0 is on/off. The CRC-16/CCITT-FALSE covers all bytes before it. Erased storage (all
+//! 0xff or 0x00) does not pass as a record.
+struct StateFormat
+{
+    static constexpr uint8_t version = 2;
+    static constexpr uint8_t record_size = 18;
+
+    static void encode(const RingState &state, uint16_t sequence, uint8_t *record);
+
+    //! \return false if the record is not valid, i.e. of another version or corrupt
+    static bool decode(const uint8_t *record, RingState &state, uint16_t &sequence);
+
+    static uint16_t crc(const uint8_t *data, uint8_t size)
+    {
+        uint16_t crc = 0xffff;
+        for(uint8_t i = 0; i < size; i++)
+        {
+            crc ^= static_cast<uint16_t>(data[i] << 8);
+            for(uint8_t bit = 0; bit < 8; bit++)
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) :
+                                       static_cast<uint16_t>(crc << 1);
+        }
+        return crc;
+    }
+
+private:
+    static void put16(uint8_t *&p, uint16_t value)
+    {
+        *p++ = static_cast<uint8_t>(value);
+        *p++ = static_cast<uint8_t>(value >> 8);
+    }
+
+    static uint16_t get16(const uint8_t *&p)
+    {
+        const uint16_t value = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        p += 2;
+        return value;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Storage on the EEPROM emulation of the ESP8266 and ESP32 (or an EEPROM alike). EEPROM.begin()
+//! needs to be called with at least StateStore::size beforehand. Note that the emulation rewrites
+//! its whole flash sector on each commit, StateStore debounces its writes therefore.
+//!
+//! \tparam Eeprom provides uint8_t read(int), void write(int, uint8_t) and bool commit()
+template <typename Eeprom> struct EepromStorage
+{
+    explicit EepromStorage(Eeprom &eeprom) : eeprom(eeprom) {}
+
+    bool read(uint16_t address, uint8_t *data, uint16_t size)
+    {
+        for(uint16_t i = 0; i < size; i++)
+            data[i] = eeprom.read(address + i);
+        return true;
+    }
+
+    bool write(uint16_t address, const uint8_t *data, uint16_t size)
+    {
+        for(uint16_t i = 0; i < size; i++)
+            eeprom.write(address + i, data[i]);
+        return eeprom.commit();
+    }
+
+    Eeprom &eeprom;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Persists the state of a ring, so that it restarts where it was after a reset. Records are
+//! written into SLOTS slots in turn, each with a sequence number; the valid record of the highest
+//! sequence wins. A write torn by a reset thus leaves the previous record intact, and the wear is
+//! spread over the slots on storage written byte by byte. Changes are written once they have been
+//! stable for the debounce time. The animation phase is not kept, a restored scene starts over.
+//!
+//!     EepromStorage<EEPROMClass> storage{ EEPROM };
+//!     StateStore<EepromStorage<EEPROMClass>> store{ storage };
+//!     // setup()
+//!     EEPROM.begin(store.size);
+//!     store.attach(ring);
+//!     ring.setup(); // shows the first frame of the restored state
+//!
+//! \tparam Storage provides bool read(uint16_t address, uint8_t *data, uint16_t size) and
+//! bool write(uint16_t address, const uint8_t *data, uint16_t size), the latter including any
+//! commit, see EepromStorage and HostFileStorage
+//! \tparam SLOTS number of records written in turn
+template <typename Storage, uint8_t SLOTS = 2> class StateStore
+{
+    static_assert(SLOTS > 0, "at least one slot is required");
+
+public:
+    //! number of bytes used from the address on
+    static constexpr uint16_t size = SLOTS * StateFormat::record_size;
+
+    //! \param address first byte used of the storage
+    explicit StateStore(Storage &storage, uint16_t address = 0)
+    : storage(storage), address(address)
+    {
+    }
+
+    //! Restores the ring from the record stored (if any) and keeps storing its state from now on,
+    //! see RingControl::setStateObserver().
+    //! \return true if the ring was restored
+    template <typename Ring> bool attach(Ring &ring)
+    {
+        RingState state;
+        const bool restored = load(state) && ring.restore(state);
+        if(!restored)
+            stored = ring.getState();
+        ring.setStateObserver(&StateStore::observe, this);
+        return restored;
+    }
+
+    //! Reads the newest valid record.
+    //! \return false if there is none
+    bool load(RingState &state);
+
+    //! Writes the state into the next slot right away.
+    //! \return false if the storage failed
+    bool save(const RingState &state);
+
+    //! Writes the state once its settings differ from the stored ones and stayed the same for the
+    //! debounce time.
+    void update(const RingState &state, uint32_t time_ms);
+
+    //! \param debounce_ms time the settings need to be stable before they are written
+    void setDebounce(uint32_t debounce_ms) { debounce = debounce_ms; }
+
+    //! \return number of records written since construction
+    uint32_t writes() const { return write_count; }
+
+    //! \return true if changed settings are waiting for the debounce time
+    bool isPending() const { return pending; }
+
+    //! State observer as of RingControl::setStateObserver().
+    static void observe(void *store, const RingState &state, uint32_t time_ms)
+    {
+        static_cast<StateStore *>(store)->update(state, time_ms);
+    }
+
+private:
+    Storage &storage;
+    uint16_t address;
+    //! settings as of the record written last
+    RingState stored;
+    //! settings waiting for the debounce time
+    RingState candidate;
+    uint32_t changed_ms{ 0 };
+    uint32_t debounce{ 5000 };
+    uint32_t write_count{ 0 };
+    uint16_t sequence{ 0 };
+    //! slot written last
+    uint8_t slot{ SLOTS - 1 };
+    bool pending{ false };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+inline void StateFormat::encode(const RingState &state, uint16_t sequence, uint8_t *record)
+{
+    uint8_t *p = record;
+    *p++ = 'P';
+    *p++ = 'S';
+    *p++ = version;
+    put16(p, sequence);
+    put16(p, state.led_count);
+    *p++ = state.scene;
+    *p++ = state.brightness;
+    *p++ = state.on ? 0x01 : 0x00;
+    put16(p, state.arc_begin);
+    put16(p, state.arc_end);
+    put16(p, state.scene_list);
+    put16(p, crc(record, record_size - 2));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool StateFormat::decode(const uint8_t *record, RingState &state, uint16_t &sequence)
+{
+    const uint8_t *p = record + record_size - 2;
+    if(record[0] != 'P' || record[1] != 'S' || record[2] != version ||
+       get16(p) != crc(record, record_size - 2))
+        return false;
+
+    p = record + 3;
+    sequence = get16(p);
+    state.led_count = get16(p);
+    state.scene = *p++;
+    state.brightness = *p++;
+    state.on = (*p++ & 0x01) != 0;
+    state.arc_begin = get16(p);
+    state.arc_end = get16(p);
+    state.scene_list = get16(p);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Storage, uint8_t SLOTS> bool StateStore<Storage, SLOTS>::load(RingState &state)
+{
+    bool found = false;
+    for(uint8_t i = 0; i < SLOTS; i++)
+    {
+        uint8_t record[StateFormat::record_size];
+        RingState candidate_state;
+        uint16_t candidate_sequence;
+        if(!storage.read(address + i * StateFormat::record_size, record, sizeof(record)) ||
+           !StateFormat::decode(record, candidate_state, candidate_sequence))
+            continue;
+
+        // sequence numbers wrap around, newer is ahead by less than half the range
+        if(!found || static_cast<int16_t>(candidate_sequence - sequence) > 0)
+        {
+            state = candidate_state;
+            sequence = candidate_sequence;
+            slot = i;
+            found = true;
+        }
+    }
+
+    if(found)
+        stored = state;
+    return found;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Storage, uint8_t SLOTS>
+bool StateStore<Storage, SLOTS>::save(const RingState &state)
+{
+    const uint8_t next_slot = static_cast<uint8_t>((slot + 1) % SLOTS);
+    uint8_t record[StateFormat::record_size];
+    StateFormat::encode(state, static_cast<uint16_t>(sequence + 1), record);
+    if(!storage.write(address + next_slot * StateFormat::record_size, record, sizeof(record)))
+        return false;
+
+    ++sequence;
+    slot = next_slot;
+    stored = state;
+    pending = false;
+    ++write_count;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Storage, uint8_t SLOTS>
+void StateStore<Storage, SLOTS>::update(const RingState &state, uint32_t time_ms)
+{
+    if(state.sameSettings(stored))
+    {
+        // unchanged or changed back meanwhile
+        pending = false;
+        return;
+    }
+
+    // each change restarts the debounce time
+    if(!pending || !state.sameSettings(candidate))
+    {
+        candidate = state;
+        changed_ms = time_ms;
+        pending = true;
+        return;
+    }
+
+    // a failed write is retried after another debounce time
+    if(time_ms - changed_ms >= debounce && !save(state))
+        changed_ms = time_ms;
+}
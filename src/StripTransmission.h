@@ -0,0 +1,31 @@
+#pragma once
+
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+
+//! Transmits the buffer of a strip. Strips providing showAsync() and waitShown() (i.e. RMT/DMA
+//! driven ones) are transmitted asynchronously, so that several strips can be put on the wire in
+//! parallel. All other strips fall back to the blocking show().
+template <typename Strip, typename = void> struct StripTransmission
+{
+    static constexpr bool is_async = false;
+
+    //! Starts the transmission, blocks until done for synchronous strips.
+    static void begin(Strip &strip) { strip.show(); }
+
+    //! Waits for the transmission started by begin() to complete.
+    static void end(Strip &) {}
+};
+
+template <typename Strip>
+struct StripTransmission<Strip,
+                         decltype(void(std::declval<Strip &>().showAsync()),
+                                  void(std::declval<Strip &>().waitShown()))>
+{
+    static constexpr bool is_async = true;
+
+    static void begin(Strip &strip) { strip.showAsync(); }
+
+    static void end(Strip &strip) { strip.waitShown(); }
+};
@@ -0,0 +1,524 @@
+#pragma once
+
+#include <stdint.h>
+#include "Compositor.h"
+#include "CrossFade.h"
+#include "PgmSpace.h"
+#include "StateStore.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! How a keyframe eases from the values before it to its own.
+enum class TimelineEasing : uint8_t
+{
+    Linear,
+    //! slow start (quadratic)
+    In,
+    //! slow end (quadratic)
+    Out,
+    //! slow start and end (smoothstep)
+    InOut
+};
+
+//! Values a timeline sets on a ring.
+struct TimelineValues
+{
+    //! tint multiplied over the whole strip, white leaves the scenes as they are
+    uint32_t color{ 0xffffff };
+    uint16_t arc_begin{ 0 };
+    uint16_t arc_width{ 0 };
+    //! position of the scene in the scene list
+    uint8_t scene{ 0 };
+    //! 5-100 [%]
+    uint8_t brightness{ 100 };
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Binary format of a timeline (a show). All numbers are little endian.
+//!
+//!     header:   'P' 'T' version flags:u8 keyframe_count:u16 duration_ms:u32
+//!     keyframe: fields:u8 ramp_ms:u16 hold_ms:u16 [scene:u8] [brightness:u8] [color:u32]
+//!               [arc_begin:u16 arc_width:u16]
+//!
+//! A keyframe eases the values it carries from the ones before it over ramp_ms, then holds them
+//! for hold_ms; values it does not carry stay as they are. The arc moves the shorter way around
+//! the ring. Scene changes take effect at the start of the keyframe, crossfaded by the ring's own
+//! transition. The fields bits tell which values follow and the easing of the ramp. duration_ms
+//! is the sum of all ramps and holds.
+//!
+//! Timelines are compiled from a text form and checked on the host, see TimelineCompiler and
+//! TimelineValidator, and stored in flash.
+struct TimelineFormat
+{
+    static constexpr uint8_t version = 1;
+    static constexpr uint8_t header_size = 10;
+
+    enum Flags : uint8_t
+    {
+        //! starts over at the end
+        Loop = 0x01,
+        //! carries colors, the timeline takes an overlay layer of the ring
+        UsesColor = 0x02
+    };
+
+    enum Fields : uint8_t
+    {
+        Scene = 0x01,
+        Brightness = 0x02,
+        Color = 0x04,
+        Arc = 0x08,
+        //! TimelineEasing
+        EasingMask = 0x30,
+        EasingShift = 4,
+        //! bits not used by this version
+        Reserved = 0xc0
+    };
+
+    struct Header
+    {
+        uint8_t flags;
+        uint16_t keyframe_count;
+        uint32_t duration_ms;
+    };
+
+    struct Keyframe
+    {
+        uint8_t fields;
+        uint16_t ramp_ms;
+        uint16_t hold_ms;
+        //! values carried, the others are undefined
+        TimelineValues values;
+
+        TimelineEasing easing() const
+        {
+            return static_cast<TimelineEasing>((fields & EasingMask) >> EasingShift);
+        }
+
+        //! \return values with the ones carried replaced
+        TimelineValues applyTo(TimelineValues previous) const;
+    };
+
+    //! \return number of bytes of a keyframe with the given fields
+    static uint8_t keyframeSize(uint8_t fields)
+    {
+        return static_cast<uint8_t>(5 + ((fields & Scene) ? 1 : 0) +
+                                    ((fields & Brightness) ? 1 : 0) + ((fields & Color) ? 4 : 0) +
+                                    ((fields & Arc) ? 4 : 0));
+    }
+
+    //! Reads the header of a timeline in flash (or RAM).
+    //! \return false if it is not a timeline of this version
+    static bool readHeader(const uint8_t *program, uint32_t size, Header &header);
+
+    //! Reads the keyframe at the given offset of a timeline in flash (or RAM).
+    //! \return number of bytes of the keyframe, 0 if it exceeds the size
+    static uint8_t readKeyframe(const uint8_t *program, uint32_t size, uint32_t offset,
+                                Keyframe &keyframe);
+
+private:
+    static uint16_t get16(const uint8_t *p)
+    {
+        return static_cast<uint16_t>(pgm_read_byte(p) | (pgm_read_byte(p + 1) << 8));
+    }
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Plays a timeline on a ring: sets scene, brightness, arc and a color tint as the keyframes say.
+//! Each update() is O(1), it reads the next keyframe once the current one is over and interpolates
+//! between two sets of values otherwise; seek() reads the keyframes up to the position once.
+//!
+//!     static const uint8_t show[] PROGMEM = { ... }; // TimelineCompiler::source()
+//!     Timeline<Ring> timeline{ ring };
+//!     // setup()
+//!     timeline.load(show, sizeof(show));
+//!     timeline.play(millis());
+//!     // loop()
+//!     timeline.update(millis());
+//!     ring.process();
+//!
+//! The ring keeps its own controls: calls to incrementBrightness(), shift() etc. apply until the
+//! timeline changes the same value again. While playing, the state of the ring is held back from
+//! its state observer (see PixelRing::holdState()), so a StateStore does not write each keyframe
+//! but the state once the timeline is stopped or finished.
+template <typename Ring> class Timeline
+{
+public:
+    enum class Status : uint8_t
+    {
+        //! nothing loaded or stopped
+        Stopped,
+        Playing,
+        //! past the end of a timeline not looping, the last values are kept
+        Finished,
+        //! the timeline loaded is corrupt, nothing is played
+        Invalid
+    };
+
+    explicit Timeline(Ring &ring) : ring(ring) {}
+
+    //! \param program timeline in flash (or RAM), kept referenced while played
+    //! \return false if it is not a timeline of this version or empty
+    bool load(const uint8_t *program, uint32_t size);
+
+    //! Plays from the start on. The values not set by a keyframe yet are the ones of the ring.
+    void play(uint32_t time_ms);
+
+    //! Continues at the given position of the timeline, looping timelines modulo their duration.
+    //! Positions beyond the first round start from the values a round ends with, as continuous
+    //! playback does.
+    void seek(uint32_t position_ms);
+
+    //! Stops playing, the ring keeps the values set last.
+    void stop() { setStatus((status_ == Status::Invalid) ? status_ : Status::Stopped); }
+
+    //! Advances to the given time and applies the values of that time to the ring; to be called
+    //! before each PixelRing::process().
+    void update(uint32_t time_ms);
+
+    Status status() const { return status_; }
+
+    //! \return position within the timeline [ms]
+    uint32_t position() const { return position_ms; }
+
+    //! \return index of the current keyframe
+    uint16_t keyframe() const { return index; }
+
+    //! \return values applied to the ring last
+    const TimelineValues &values() const { return applied; }
+
+    //! \return ease weight 0-256 of the linear weight 0-256
+    static uint16_t ease(TimelineEasing easing, uint16_t weight);
+
+private:
+    //! Holds the state of the ring back from its state observer while playing.
+    void setStatus(Status status)
+    {
+        status_ = status;
+        ring.holdState(status == Status::Playing);
+    }
+
+    //! Reads the first keyframe.
+    bool rewind();
+
+    //! Applies all keyframes to the values, i.e. yields the values a round of the timeline ends
+    //! with: each of them is set by the last keyframe carrying it or kept otherwise.
+    bool applyAll(TimelineValues &values);
+
+    //! Moves on to the keyframe at the position.
+    void advance();
+
+    //! Applies the values of the position to the ring.
+    void apply(bool force);
+
+    static uint16_t lerp(uint16_t from, uint16_t to, uint16_t weight)
+    {
+        return (from < to) ? static_cast<uint16_t>(from + (((to - from) * weight) >> 8)) :
+                             static_cast<uint16_t>(from - (((from - to) * weight) >> 8));
+    }
+
+    //! Interpolates a pixel the shorter way around the ring, i.e. 20 to 2 via 0 on 24 pixels.
+    static uint16_t lerpAround(uint16_t from, uint16_t to, uint16_t weight)
+    {
+        const int32_t n = Ring::led_count;
+        int32_t distance = ((static_cast<int32_t>(to) - from) % n + n) % n;
+        distance = (distance > n / 2) ? distance - n : distance;
+        return static_cast<uint16_t>((from % n + n + distance * weight / 256) % n);
+    }
+
+    Ring &ring;
+    const uint8_t *program{ nullptr };
+    uint32_t size{ 0 };
+    TimelineFormat::Header header{};
+    //! current keyframe
+    TimelineFormat::Keyframe current{};
+    uint32_t offset{ 0 };
+    uint16_t index{ 0 };
+    //! time the current keyframe started at within the timeline
+    uint32_t keyframe_ms{ 0 };
+    uint32_t position_ms{ 0 };
+    uint32_t time_ms{ 0 };
+    //! values of the ring when played
+    TimelineValues initial;
+    //! values before and after the current keyframe
+    TimelineValues from;
+    TimelineValues to;
+    TimelineValues applied;
+    uint8_t overlay{ Ring::Layers::none };
+    Status status_{ Status::Stopped };
+};
+
+// -------------------------------------------------------------------------------------------------
+
+inline TimelineValues TimelineFormat::Keyframe::applyTo(TimelineValues previous) const
+{
+    if(fields & Scene)
+        previous.scene = values.scene;
+    if(fields & Brightness)
+        previous.brightness = values.brightness;
+    if(fields & Color)
+        previous.color = values.color;
+    if(fields & Arc)
+    {
+        previous.arc_begin = values.arc_begin;
+        previous.arc_width = values.arc_width;
+    }
+    return previous;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool TimelineFormat::readHeader(const uint8_t *program, uint32_t size, Header &header)
+{
+    if(size < header_size || pgm_read_byte(program) != 'P' || pgm_read_byte(program + 1) != 'T' ||
+       pgm_read_byte(program + 2) != version)
+        return false;
+
+    header.flags = pgm_read_byte(program + 3);
+    header.keyframe_count = get16(program + 4);
+    header.duration_ms = get32(program + 6);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline uint8_t TimelineFormat::readKeyframe(const uint8_t *program, uint32_t size, uint32_t offset,
+                                            Keyframe &keyframe)
+{
+    if(offset >= size)
+        return 0;
+    const uint8_t fields = pgm_read_byte(program + offset);
+    const uint8_t keyframe_size = keyframeSize(fields);
+    if(keyframe_size > size - offset)
+        return 0;
+
+    const uint8_t *p = program + offset;
+    keyframe.fields = fields;
+    keyframe.ramp_ms = get16(p + 1);
+    keyframe.hold_ms = get16(p + 3);
+    p += 5;
+    if(fields & Scene)
+        keyframe.values.scene = pgm_read_byte(p++);
+    if(fields & Brightness)
+        keyframe.values.brightness = pgm_read_byte(p++);
+    if(fields & Color)
+    {
+        keyframe.values.color = get32(p);
+        p += 4;
+    }
+    if(fields & Arc)
+    {
+        keyframe.values.arc_begin = get16(p);
+        keyframe.values.arc_width = get16(p + 2);
+    }
+    return keyframe_size;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> bool Timeline<Ring>::load(const uint8_t *new_program, uint32_t new_size)
+{
+    program = new_program;
+    size = new_size;
+    const bool valid = TimelineFormat::readHeader(program, size, header) &&
+                       header.keyframe_count > 0 &&
+                       (header.duration_ms > 0 || !(header.flags & TimelineFormat::Loop));
+    setStatus(valid ? Status::Stopped : Status::Invalid);
+    return valid;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> void Timeline<Ring>::play(uint32_t now_ms)
+{
+    if(status_ == Status::Invalid || program == nullptr)
+        return;
+
+    const RingState state = ring.getState();
+    initial.scene = state.scene;
+    initial.brightness = state.brightness;
+    initial.arc_begin = state.arc_begin;
+    const uint16_t n = Ring::led_count;
+    initial.arc_width = static_cast<uint16_t>((state.arc_end + n - state.arc_begin) % n + 1);
+    initial.color = 0xffffff;
+
+    if((header.flags & TimelineFormat::UsesColor) && overlay == Ring::Layers::none)
+        overlay = ring.getLayers().addOverlay(0, n, initial.color, BlendMode::Multiply);
+
+    time_ms = now_ms;
+    seek(0);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> void Timeline<Ring>::seek(uint32_t new_position_ms)
+{
+    if(status_ == Status::Invalid || program == nullptr)
+        return;
+
+    const bool loop = header.flags & TimelineFormat::Loop;
+    position_ms = loop ? new_position_ms % header.duration_ms : new_position_ms;
+    from = initial;
+    // the later rounds start where the previous round ended, not at the values of the ring
+    if(loop && new_position_ms >= header.duration_ms && !applyAll(from))
+        return;
+    if(!rewind())
+        return;
+    setStatus(Status::Playing);
+    advance();
+    if(status_ != Status::Invalid)
+        apply(true);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> void Timeline<Ring>::update(uint32_t now_ms)
+{
+    const uint32_t dt_ms = now_ms - time_ms;
+    time_ms = now_ms;
+    if(status_ != Status::Playing)
+        return;
+
+    position_ms += dt_ms;
+    advance();
+    if(status_ != Status::Invalid)
+        apply(false);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> uint16_t Timeline<Ring>::ease(TimelineEasing easing, uint16_t weight)
+{
+    const uint32_t w = weight;
+    switch(easing)
+    {
+    case TimelineEasing::In:
+        return static_cast<uint16_t>((w * w) >> 8);
+    case TimelineEasing::Out:
+        return static_cast<uint16_t>(256 - (((256 - w) * (256 - w)) >> 8));
+    case TimelineEasing::InOut:
+        // 3w^2 - 2w^3 in 1/256
+        return static_cast<uint16_t>((w * w * (768 - 2 * w)) >> 16);
+    case TimelineEasing::Linear:
+    default:
+        return weight;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> bool Timeline<Ring>::rewind()
+{
+    offset = TimelineFormat::header_size;
+    index = 0;
+    keyframe_ms = 0;
+    const uint8_t keyframe_size = TimelineFormat::readKeyframe(program, size, offset, current);
+    if(keyframe_size == 0)
+    {
+        setStatus(Status::Invalid);
+        return false;
+    }
+    to = current.applyTo(from);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> bool Timeline<Ring>::applyAll(TimelineValues &values)
+{
+    uint32_t at = TimelineFormat::header_size;
+    TimelineFormat::Keyframe keyframe{};
+    for(uint16_t i = 0; i < header.keyframe_count; i++)
+    {
+        const uint8_t keyframe_size = TimelineFormat::readKeyframe(program, size, at, keyframe);
+        if(keyframe_size == 0)
+        {
+            setStatus(Status::Invalid);
+            return false;
+        }
+        values = keyframe.applyTo(values);
+        at += keyframe_size;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> void Timeline<Ring>::advance()
+{
+    // usually no or one keyframe per update, more only for keyframes shorter than a frame
+    for(;;)
+    {
+        const uint32_t end_ms = keyframe_ms + current.ramp_ms + current.hold_ms;
+        if(position_ms < end_ms)
+            return;
+
+        if(index + 1 == header.keyframe_count)
+        {
+            if(!(header.flags & TimelineFormat::Loop))
+            {
+                // holds the values of the last keyframe
+                setStatus(Status::Finished);
+                position_ms = end_ms;
+                return;
+            }
+            if(end_ms == 0)
+            {
+                // would loop forever within a single update
+                setStatus(Status::Invalid);
+                return;
+            }
+            position_ms -= end_ms;
+            from = to;
+            if(!rewind())
+                return;
+            continue;
+        }
+
+        keyframe_ms = end_ms;
+        offset += TimelineFormat::keyframeSize(current.fields);
+        index++;
+        from = to;
+        if(TimelineFormat::readKeyframe(program, size, offset, current) == 0)
+        {
+            setStatus(Status::Invalid);
+            return;
+        }
+        to = current.applyTo(from);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <typename Ring> void Timeline<Ring>::apply(bool force)
+{
+    const uint16_t weight =
+    ease(current.easing(), CrossFade::weight(position_ms - keyframe_ms, current.ramp_ms));
+
+    TimelineValues values;
+    values.scene = to.scene;
+    values.brightness = static_cast<uint8_t>(lerp(from.brightness, to.brightness, weight));
+    values.color = CrossFade::blend(from.color, to.color, weight);
+    values.arc_begin = lerpAround(from.arc_begin, to.arc_begin, weight);
+    values.arc_width = lerp(from.arc_width, to.arc_width, weight);
+
+    // only changes reach the ring, static scenes keep skipping their frames
+    if(force || values.scene != applied.scene)
+        ring.setScene(values.scene);
+    if(force || values.brightness != applied.brightness)
+        ring.setBrightness(values.brightness);
+    if(force || values.arc_begin != applied.arc_begin || values.arc_width != applied.arc_width)
+        ring.setArc(values.arc_begin, values.arc_width);
+    if(overlay != Ring::Layers::none && (force || values.color != applied.color))
+    {
+        ring.getLayers().setColor(overlay, values.color);
+        ring.getLayers().setEnabled(overlay, values.color != 0xffffff);
+    }
+    applied = values;
+}
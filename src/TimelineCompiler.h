@@ -0,0 +1,320 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Timeline.h"
+
+//--------------------------------------------------------------------------------------------------
+
+//! Compiles the text form of a timeline into its binary form, see TimelineFormat. Host only.
+//!
+//!     # comments start with a hash
+//!     loop
+//!     key hold 2000 scene Rainbow brightness 30 arc 0 24
+//!     key ramp 3000 ease in-out hold 1000 brightness 100 color ff8000
+//!     key ramp 500 ease out arc 6 12
+//!
+//! Each key line is a keyframe: ramp and hold in [ms] (0 by default, 65535 at most), ease one of
+//! linear (default), in, out and in-out, scene an index or a name given to the compiler,
+//! brightness 5-100 [%], color as hex rrggbb or wwrrggbb, arc begin and width in pixels. The line
+//! loop (anywhere) starts the timeline over at its end.
+class TimelineCompiler
+{
+public:
+    //! \param scene_names names of the scenes in list order, scenes may be given by index anyway
+    explicit TimelineCompiler(std::vector<std::string> scene_names = {})
+    : scene_names(std::move(scene_names))
+    {
+    }
+
+    //! \return false if the text is malformed, see error()
+    bool compile(const std::string &text, std::vector<uint8_t> &program);
+
+    //! \return the problem the last compile() failed on, with its line number
+    const std::string &error() const { return message; }
+
+    //! \return the program as a C array in flash to be included into a sketch
+    static std::string source(const std::string &name, const std::vector<uint8_t> &program);
+
+private:
+    bool fail(unsigned line, const std::string &what)
+    {
+        message = "line " + std::to_string(line) + ": " + what;
+        return false;
+    }
+
+    //! \return false if the word is not a number within [min, max]
+    static bool number(const std::string &word, uint32_t min, uint32_t max, uint32_t &value);
+
+    static void put16(std::vector<uint8_t> &program, uint16_t value)
+    {
+        program.push_back(static_cast<uint8_t>(value));
+        program.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    static void put32(std::vector<uint8_t> &program, uint32_t value)
+    {
+        put16(program, static_cast<uint16_t>(value));
+        put16(program, static_cast<uint16_t>(value >> 16));
+    }
+
+    std::vector<std::string> scene_names;
+    std::string message;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//! Checks the binary form of a timeline against the ring it is meant for. Host only; the
+//! interpreter only guards against reading beyond the program.
+struct TimelineValidator
+{
+    //! \param scene_count number of scenes in the scene list of the ring
+    //! \param led_count number of pixels of the ring
+    //! \param error the first problem found
+    //! \return false if the timeline is not valid for the ring
+    static bool validate(const uint8_t *program,
+                         uint32_t size,
+                         uint8_t scene_count,
+                         uint16_t led_count,
+                         std::string &error);
+};
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool TimelineCompiler::compile(const std::string &text, std::vector<uint8_t> &program)
+{
+    static const char *const easings[] = { "linear", "in", "out", "in-out" };
+
+    std::vector<uint8_t> keyframes;
+    uint8_t flags = 0;
+    uint16_t keyframe_count = 0;
+    uint32_t duration_ms = 0;
+
+    std::istringstream lines{ text };
+    std::string line;
+    for(unsigned line_number = 1; std::getline(lines, line); line_number++)
+    {
+        std::istringstream words{ line.substr(0, line.find('#')) };
+        std::string word;
+        if(!(words >> word))
+            continue;
+        if(word == "loop")
+        {
+            flags |= TimelineFormat::Loop;
+            continue;
+        }
+        if(word != "key")
+            return fail(line_number, "expected key or loop, got '" + word + "'");
+        if(keyframe_count == UINT16_MAX)
+            return fail(line_number, "too many keyframes");
+
+        TimelineFormat::Keyframe keyframe{};
+        uint32_t value;
+        while(words >> word)
+        {
+            std::string argument;
+            if(!(words >> argument))
+                return fail(line_number, "missing value of " + word);
+
+            if(word == "ramp" || word == "hold")
+            {
+                if(!number(argument, 0, UINT16_MAX, value))
+                    return fail(line_number, word + " must be 0-65535 ms");
+                uint16_t &duration = (word == "ramp") ? keyframe.ramp_ms : keyframe.hold_ms;
+                duration = static_cast<uint16_t>(value);
+            }
+            else if(word == "ease")
+            {
+                uint8_t easing = 0;
+                while(easing < 4 && argument != easings[easing])
+                    easing++;
+                if(easing == 4)
+                    return fail(line_number, "unknown easing '" + argument + "'");
+                keyframe.fields &= static_cast<uint8_t>(~TimelineFormat::EasingMask);
+                keyframe.fields |= static_cast<uint8_t>(easing << TimelineFormat::EasingShift);
+            }
+            else if(word == "scene")
+            {
+                value = 0;
+                while(value < scene_names.size() && scene_names[value] != argument)
+                    value++;
+                if(value == scene_names.size() && !number(argument, 0, UINT8_MAX, value))
+                    return fail(line_number, "unknown scene '" + argument + "'");
+                keyframe.values.scene = static_cast<uint8_t>(value);
+                keyframe.fields |= TimelineFormat::Scene;
+            }
+            else if(word == "brightness")
+            {
+                if(!number(argument, 5, 100, value))
+                    return fail(line_number, "brightness must be 5-100 %");
+                keyframe.values.brightness = static_cast<uint8_t>(value);
+                keyframe.fields |= TimelineFormat::Brightness;
+            }
+            else if(word == "color")
+            {
+                if((argument.size() != 6 && argument.size() != 8) ||
+                   argument.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+                    return fail(line_number, "color must be rrggbb or wwrrggbb");
+                keyframe.values.color =
+                static_cast<uint32_t>(std::strtoul(argument.c_str(), nullptr, 16));
+                keyframe.fields |= TimelineFormat::Color;
+                flags |= TimelineFormat::UsesColor;
+            }
+            else if(word == "arc")
+            {
+                std::string width;
+                if(!number(argument, 0, UINT16_MAX, value) || !(words >> width))
+                    return fail(line_number, "arc needs begin and width");
+                keyframe.values.arc_begin = static_cast<uint16_t>(value);
+                if(!number(width, 1, UINT16_MAX, value))
+                    return fail(line_number, "arc width must be 1 at least");
+                keyframe.values.arc_width = static_cast<uint16_t>(value);
+                keyframe.fields |= TimelineFormat::Arc;
+            }
+            else
+                return fail(line_number, "unknown value '" + word + "'");
+        }
+
+        keyframes.push_back(keyframe.fields);
+        put16(keyframes, keyframe.ramp_ms);
+        put16(keyframes, keyframe.hold_ms);
+        if(keyframe.fields & TimelineFormat::Scene)
+            keyframes.push_back(keyframe.values.scene);
+        if(keyframe.fields & TimelineFormat::Brightness)
+            keyframes.push_back(keyframe.values.brightness);
+        if(keyframe.fields & TimelineFormat::Color)
+            put32(keyframes, keyframe.values.color);
+        if(keyframe.fields & TimelineFormat::Arc)
+        {
+            put16(keyframes, keyframe.values.arc_begin);
+            put16(keyframes, keyframe.values.arc_width);
+        }
+        keyframe_count++;
+        duration_ms += keyframe.ramp_ms + keyframe.hold_ms;
+    }
+
+    if(keyframe_count == 0)
+        return fail(1, "no keyframes");
+    if((flags & TimelineFormat::Loop) && duration_ms == 0)
+        return fail(1, "a loop needs a duration");
+
+    program = { 'P', 'T', TimelineFormat::version, flags };
+    put16(program, keyframe_count);
+    put32(program, duration_ms);
+    program.insert(program.end(), keyframes.begin(), keyframes.end());
+    message.clear();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool TimelineCompiler::number(const std::string &word, uint32_t min, uint32_t max,
+                                     uint32_t &value)
+{
+    if(word.empty() || word.size() > 9 || word.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    value = static_cast<uint32_t>(std::stoul(word));
+    return value >= min && value <= max;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::string TimelineCompiler::source(const std::string &name,
+                                            const std::vector<uint8_t> &program)
+{
+    std::string text = "static const uint8_t " + name + "[] PROGMEM = {";
+    char byte[8];
+    for(size_t i = 0; i < program.size(); i++)
+    {
+        std::snprintf(byte, sizeof(byte), "0x%02x", program[i]);
+        text += ((i % 12) == 0) ? "\n    " : " ";
+        text += byte;
+        text += (i + 1 < program.size()) ? "," : "";
+    }
+    return text + "\n};\n";
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool TimelineValidator::validate(const uint8_t *program,
+                                        uint32_t size,
+                                        uint8_t scene_count,
+                                        uint16_t led_count,
+                                        std::string &error)
+{
+    TimelineFormat::Header header;
+    if(!TimelineFormat::readHeader(program, size, header))
+    {
+        error = "not a timeline of version " + std::to_string(TimelineFormat::version);
+        return false;
+    }
+    if((header.flags & ~(TimelineFormat::Loop | TimelineFormat::UsesColor)) != 0)
+    {
+        error = "unknown flags";
+        return false;
+    }
+    if(header.keyframe_count == 0)
+    {
+        error = "no keyframes";
+        return false;
+    }
+
+    uint32_t offset = TimelineFormat::header_size;
+    uint32_t duration_ms = 0;
+    bool uses_color = false;
+    for(uint16_t i = 0; i < header.keyframe_count; i++)
+    {
+        const std::string where = "keyframe " + std::to_string(i) + ": ";
+        TimelineFormat::Keyframe keyframe{};
+        const uint8_t keyframe_size = TimelineFormat::readKeyframe(program, size, offset, keyframe);
+        if(keyframe_size == 0)
+        {
+            error = where + "truncated";
+            return false;
+        }
+        if(keyframe.fields & TimelineFormat::Reserved)
+        {
+            error = where + "unknown fields";
+            return false;
+        }
+        if((keyframe.fields & TimelineFormat::Scene) && keyframe.values.scene >= scene_count)
+        {
+            error = where + "scene " + std::to_string(keyframe.values.scene) + " of " +
+                    std::to_string(scene_count);
+            return false;
+        }
+        if((keyframe.fields & TimelineFormat::Brightness) &&
+           (keyframe.values.brightness < 5 || keyframe.values.brightness > 100))
+        {
+            error = where + "brightness beyond 5-100 %";
+            return false;
+        }
+        if((keyframe.fields & TimelineFormat::Arc) &&
+           (keyframe.values.arc_begin >= led_count || keyframe.values.arc_width == 0 ||
+            keyframe.values.arc_width > led_count))
+        {
+            error = where + "arc beyond " + std::to_string(led_count) + " pixels";
+            return false;
+        }
+        uses_color = uses_color || (keyframe.fields & TimelineFormat::Color);
+        duration_ms += keyframe.ramp_ms + keyframe.hold_ms;
+        offset += keyframe_size;
+    }
+
+    if(offset != size)
+        error = "trailing bytes after the last keyframe";
+    else if(duration_ms != header.duration_ms)
+        error = "duration " + std::to_string(header.duration_ms) + " ms, keyframes take " +
+                std::to_string(duration_ms) + " ms";
+    else if((header.flags & TimelineFormat::Loop) && duration_ms == 0)
+        error = "a loop needs a duration";
+    else if(uses_color != ((header.flags & TimelineFormat::UsesColor) != 0))
+        error = "color flag does not match the keyframes";
+    else
+        return true;
+    return false;
+}